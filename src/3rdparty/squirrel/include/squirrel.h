@@ -324,6 +324,9 @@ SQRESULT sq_getobjtypetag(HSQOBJECT *o,SQUserPointer * typetag);
 
 /*GC*/
 SQInteger sq_collectgarbage(HSQUIRRELVM v);
+void sq_collectgarbage_start(HSQUIRRELVM v);
+SQBool sq_collectgarbage_step(HSQUIRRELVM v,SQInteger work,SQInteger *collected);
+SQBool sq_collectgarbage_running(HSQUIRRELVM v);
 
 /*serialization*/
 SQRESULT sq_writeclosure(HSQUIRRELVM vm,SQWRITEFUNC writef,SQUserPointer up);
@@ -1090,6 +1090,33 @@ SQInteger sq_collectgarbage(HSQUIRRELVM v)
 #endif
 }
 
+void sq_collectgarbage_start(HSQUIRRELVM v)
+{
+#ifndef NO_GARBAGE_COLLECTOR
+	if(!_ss(v)->IsCollecting()) _ss(v)->StartCollection(true);
+#endif
+}
+
+SQBool sq_collectgarbage_step(HSQUIRRELVM v,SQInteger work,SQInteger *collected)
+{
+#ifndef NO_GARBAGE_COLLECTOR
+	if(!_ss(v)->StepCollection(work)) return SQFalse;
+	if(collected) *collected = _ss(v)->_gc_collected;
+#else
+	if(collected) *collected = 0;
+#endif
+	return SQTrue;
+}
+
+SQBool sq_collectgarbage_running(HSQUIRRELVM v)
+{
+#ifndef NO_GARBAGE_COLLECTOR
+	return _ss(v)->IsCollecting() ? SQTrue : SQFalse;
+#else
+	return SQFalse;
+#endif
+}
+
 const SQChar *sq_getfreevariable(HSQUIRRELVM v,SQInteger idx,SQUnsignedInteger nval)
 {
 	SQObjectPtr &self = stack_get(v,idx);
@@ -12,7 +12,7 @@ private:
 	}
 public:
 	static SQArray* Create(SQSharedState *ss,SQInteger nInitialSize){
-		SQArray *newarray=(SQArray*)SQ_MALLOC(sizeof(SQArray));
+		SQArray *newarray=sq_pool_new(ss,SQArray);
 		new (newarray) SQArray(ss,nInitialSize);
 		return newarray;
 	}
@@ -80,7 +80,7 @@ public:
 	}
 	void Release()
 	{
-		sq_delete(this,SQArray);
+		sq_pool_delete(this,SQArray);
 	}
 	SQObjectPtrVec _values;
 };
@@ -10,12 +10,12 @@ private:
 	SQClosure(SQSharedState *ss,SQFunctionProto *func){_function=func; INIT_CHAIN();ADD_TO_CHAIN(&_ss(this)->_gc_chain,this);}
 public:
 	static SQClosure *Create(SQSharedState *ss,SQFunctionProto *func){
-		SQClosure *nc=(SQClosure*)SQ_MALLOC(sizeof(SQClosure));
+		SQClosure *nc=sq_pool_new(ss,SQClosure);
 		new (nc) SQClosure(ss,func);
 		return nc;
 	}
 	void Release(){
-		sq_delete(this,SQClosure);
+		sq_pool_delete(this,SQClosure);
 	}
 	SQClosure *Clone()
 	{
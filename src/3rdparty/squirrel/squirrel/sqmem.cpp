@@ -14,3 +14,65 @@ void *sq_vm_malloc(SQUnsignedInteger size){	return MallocT<char>((size_t)size);
 void *sq_vm_realloc(void *p, SQUnsignedInteger oldsize, SQUnsignedInteger size){ return ReallocT<char>(static_cast<char*>(p), (size_t)size); }
 
 void sq_vm_free(void *p, SQUnsignedInteger size){	free(p); }
+
+SQAllocPool::SQAllocPool()
+{
+	memset(_free, 0, sizeof(_free));
+	_chunks = NULL;
+	_cur = NULL;
+	_end = NULL;
+	_allocs = 0;
+	_bytes_used = 0;
+	_bytes_reserved = 0;
+}
+
+SQAllocPool::~SQAllocPool()
+{
+	while (_chunks != NULL) {
+		void *next = *(void **)_chunks;
+		free(_chunks);
+		_chunks = next;
+	}
+}
+
+void *SQAllocPool::Alloc(SQUnsignedInteger size)
+{
+	if (size == 0 || size > GRANULE * NUM_CLASSES) return sq_vm_malloc(size);
+
+	SQUnsignedInteger cls = (size - 1) / GRANULE;
+	SQUnsignedInteger bytes = (cls + 1) * GRANULE;
+	_allocs++;
+	_bytes_used += bytes;
+
+	void *p = _free[cls];
+	if (p != NULL) {
+		_free[cls] = *(void **)p;
+		return p;
+	}
+
+	if (_cur == NULL || (SQUnsignedInteger)(_end - _cur) < bytes) {
+		/* The rest of the current chunk is too small; new chunk, first granule links the chunks. */
+		char *chunk = MallocT<char>(CHUNK_SIZE);
+		*(void **)chunk = _chunks;
+		_chunks = chunk;
+		_cur = chunk + GRANULE;
+		_end = chunk + CHUNK_SIZE;
+		_bytes_reserved += CHUNK_SIZE;
+	}
+	p = _cur;
+	_cur += bytes;
+	return p;
+}
+
+void SQAllocPool::Free(void *p, SQUnsignedInteger size)
+{
+	if (size == 0 || size > GRANULE * NUM_CLASSES) {
+		sq_vm_free(p, size);
+		return;
+	}
+
+	SQUnsignedInteger cls = (size - 1) / GRANULE;
+	_bytes_used -= (cls + 1) * GRANULE;
+	*(void **)p = _free[cls];
+	_free[cls] = p;
+}
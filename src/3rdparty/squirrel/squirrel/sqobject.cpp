@@ -486,11 +486,9 @@ bool SQFunctionProto::Load(SQVM *v,SQUserPointer up,SQREADFUNC read,SQObjectPtr
 
 #ifndef NO_GARBAGE_COLLECTOR
 
-#define START_MARK() 	if(!(_uiRef&MARK_FLAG)){ \
-		_uiRef|=MARK_FLAG;
+#define START_MARK() 	if(_sharedstate->ShadeForMark(this,chain)){
 
-#define END_MARK() RemoveFromChain(&_sharedstate->_gc_chain, this); \
-		AddToChain(chain, this); }
+#define END_MARK() }
 
 void SQVM::Mark(SQCollectable **chain)
 {
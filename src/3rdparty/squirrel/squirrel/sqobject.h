@@ -352,7 +352,8 @@ struct SQCollectable : public SQRefCounted {
 };
 
 
-#define ADD_TO_CHAIN(chain,obj) AddToChain(chain,obj)
+//chain is always _gc_chain, but an object made during the marking of an incremental collection joins the marked objects
+#define ADD_TO_CHAIN(chain,obj) _sharedstate->AddCollectable(obj)
 #define REMOVE_FROM_CHAIN(chain,obj) {if(!(_uiRef&MARK_FLAG))RemoveFromChain(chain,obj);}
 #define CHAINABLE_OBJ SQCollectable
 #define INIT_CHAIN() {_next=NULL;_prev=NULL;_sharedstate=ss;}
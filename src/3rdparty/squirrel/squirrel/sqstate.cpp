@@ -101,6 +101,12 @@ SQSharedState::SQSharedState()
 	_scratchpadsize=0;
 #ifndef NO_GARBAGE_COLLECTOR
 	_gc_chain=NULL;
+	_gc_phase=GC_IDLE;
+	_gc_incremental=false;
+	_gc_marked=NULL;
+	_gc_cursor=NULL;
+	_gc_scanning=NULL;
+	_gc_collected=0;
 #endif
 	sq_new(_stringtable,SQStringTable);
 	sq_new(_metamethods,SQObjectPtrVec);
@@ -162,6 +168,10 @@ SQSharedState::SQSharedState()
 
 SQSharedState::~SQSharedState()
 {
+#ifndef NO_GARBAGE_COLLECTOR
+	//the objects of an unfinished collection are not in _gc_chain
+	if(IsCollecting()) CollectGarbage(NULL);
+#endif
 	_constructoridx = _null_;
 	_table(_registry)->Finalize();
 	_table(_consts)->Finalize();
@@ -245,53 +255,121 @@ void SQSharedState::MarkObject(SQObjectPtr &o,SQCollectable **chain)
 }
 
 
-SQInteger SQSharedState::CollectGarbage(SQVM *vm)
+void SQSharedState::MarkRoots(SQCollectable **chain)
 {
-	SQInteger n=0;
-	SQCollectable *tchain=NULL;
-	SQVM *vms = _thread(_root_vm);
+	_thread(_root_vm)->Mark(chain);
+	_refs_table.Mark(chain);
+	MarkObject(_registry,chain);
+	MarkObject(_consts,chain);
+	MarkObject(_metamethodsmap,chain);
+	MarkObject(_table_default_delegate,chain);
+	MarkObject(_array_default_delegate,chain);
+	MarkObject(_string_default_delegate,chain);
+	MarkObject(_number_default_delegate,chain);
+	MarkObject(_generator_default_delegate,chain);
+	MarkObject(_thread_default_delegate,chain);
+	MarkObject(_closure_default_delegate,chain);
+	MarkObject(_class_default_delegate,chain);
+	MarkObject(_instance_default_delegate,chain);
+	MarkObject(_weakref_default_delegate,chain);
+}
 
-	vms->Mark(&tchain);
-	SQInteger x = _table(_thread(_root_vm)->_roottable)->CountUsed();
-	_refs_table.Mark(&tchain);
-	MarkObject(_registry,&tchain);
-	MarkObject(_consts,&tchain);
-	MarkObject(_metamethodsmap,&tchain);
-	MarkObject(_table_default_delegate,&tchain);
-	MarkObject(_array_default_delegate,&tchain);
-	MarkObject(_string_default_delegate,&tchain);
-	MarkObject(_number_default_delegate,&tchain);
-	MarkObject(_generator_default_delegate,&tchain);
-	MarkObject(_thread_default_delegate,&tchain);
-	MarkObject(_closure_default_delegate,&tchain);
-	MarkObject(_class_default_delegate,&tchain);
-	MarkObject(_instance_default_delegate,&tchain);
-	MarkObject(_weakref_default_delegate,&tchain);
+bool SQSharedState::ShadeForMark(SQCollectable *c,SQCollectable **chain)
+{
+	if(c == _gc_scanning) {
+		//taken from the gray list, scan its references now
+		_gc_scanning = NULL;
+		return true;
+	}
+	if(c->_uiRef&MARK_FLAG) return false;
+	c->_uiRef|=MARK_FLAG;
+	SQCollectable::RemoveFromChain(&_gc_chain, c);
+	SQCollectable::AddToChain(chain, c);
+	if(!_gc_incremental) return true;
+	_gc_gray.push_back(c);
+	return false;
+}
 
-	SQCollectable *t = _gc_chain;
-	SQCollectable *nx = NULL;
-	if(t) {
-		t->_uiRef++;
-		while(t) {
+void SQSharedState::AddCollectable(SQCollectable *c)
+{
+	if(_gc_phase == GC_MARK) {
+		//the objects it will reference may not be marked yet, so scan it later
+		c->_uiRef|=MARK_FLAG;
+		SQCollectable::AddToChain(&_gc_marked, c);
+		_gc_gray.push_back(c);
+		return;
+	}
+	//while sweeping it goes before the cursor, so it is not finalized
+	SQCollectable::AddToChain(&_gc_chain, c);
+}
+
+void SQSharedState::StartCollection(bool incremental)
+{
+	assert(!IsCollecting());
+	_gc_phase = GC_MARK;
+	_gc_incremental = incremental;
+	_gc_marked = NULL;
+	_gc_collected = 0;
+	MarkRoots(&_gc_marked);
+}
+
+SQBool SQSharedState::StepCollection(SQInteger work)
+{
+	//a negative amount of work never reaches zero, so it finishes the collection
+	if(_gc_phase == GC_MARK) {
+		while(!_gc_gray.empty()) {
+			if(work-- == 0) return SQFalse;
+			_gc_scanning = _gc_gray.back();
+			_gc_gray.pop_back();
+			_gc_scanning->Mark(&_gc_marked);
+		}
+		_gc_phase = GC_SWEEP;
+		_gc_cursor = _gc_chain;
+		if(_gc_cursor) _gc_cursor->_uiRef++;
+	}
+	if(_gc_phase == GC_SWEEP) {
+		while(_gc_cursor) {
+			if(work-- == 0) return SQFalse;
+			SQCollectable *t = _gc_cursor;
 			t->Finalize();
-			nx = t->_next;
+			SQCollectable *nx = t->_next;
 			if(nx) nx->_uiRef++;
 			if(--t->_uiRef == 0)
 				t->Release();
-			t = nx;
-			n++;
+			_gc_cursor = nx;
+			_gc_collected++;
+		}
+		_gc_phase = GC_UNMARK;
+	}
+	if(_gc_phase == GC_UNMARK) {
+		//move the objects one by one, so an unmarked object is always in _gc_chain
+		while(_gc_marked) {
+			if(work-- == 0) return SQFalse;
+			SQCollectable *t = _gc_marked;
+			t->UnMark();
+			SQCollectable::RemoveFromChain(&_gc_marked, t);
+			SQCollectable::AddToChain(&_gc_chain, t);
 		}
+		_gc_phase = GC_IDLE;
 	}
+	return SQTrue;
+}
 
-	t = tchain;
-	while(t) {
-		t->UnMark();
-		t = t->_next;
+SQInteger SQSharedState::CollectGarbage(SQVM *vm)
+{
+	if(IsCollecting()) {
+		//finish the running incremental collection at once
+		_gc_incremental = false;
+		StepCollection(-1);
+		return _gc_collected;
 	}
-	_gc_chain = tchain;
+
+	SQInteger x = _table(_thread(_root_vm)->_roottable)->CountUsed();
+	StartCollection(false);
+	StepCollection(-1);
 	SQInteger z = _table(_thread(_root_vm)->_roottable)->CountUsed();
 	assert(z == x);
-	return n;
+	return _gc_collected;
 }
 #endif
 
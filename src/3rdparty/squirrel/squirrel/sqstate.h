@@ -54,6 +54,16 @@ private:
 
 struct SQObjectPtr;
 
+#ifndef NO_GARBAGE_COLLECTOR
+//phases of a garbage collection
+enum SQGCPhase {
+	GC_IDLE,	//no collection running
+	GC_MARK,	//finding the reachable objects
+	GC_SWEEP,	//finalizing the objects that were not reached
+	GC_UNMARK,	//clearing the mark of the reachable objects
+};
+#endif
+
 struct SQSharedState
 {
 	SQSharedState();
@@ -63,8 +73,14 @@ public:
 	SQInteger GetMetaMethodIdxByName(const SQObjectPtr &name);
 #ifndef NO_GARBAGE_COLLECTOR
 	SQInteger CollectGarbage(SQVM *vm);
+	void StartCollection(bool incremental);
+	SQBool StepCollection(SQInteger work);
+	bool IsCollecting() const { return _gc_phase != GC_IDLE; }
+	bool ShadeForMark(SQCollectable *c,SQCollectable **chain);
+	void AddCollectable(SQCollectable *c);
 	static void MarkObject(SQObjectPtr &o,SQCollectable **chain);
 #endif
+	SQAllocPool _pool; //declared first, so it is destroyed after everything allocated from it
 	SQObjectPtrVec *_metamethods;
 	SQObjectPtr _metamethodsmap;
 	SQObjectPtrVec *_systemstrings;
@@ -76,6 +92,18 @@ public:
 	SQObjectPtr _constructoridx;
 #ifndef NO_GARBAGE_COLLECTOR
 	SQCollectable *_gc_chain;
+	//state of the running collection; an incremental one is done in steps,
+	//the VM must not run until it is finished as there is no write barrier.
+	//marked objects can not be freed, as the mark flag keeps their reference
+	//count above zero, and unmarked objects are always in _gc_chain, so
+	//objects freed between the steps are never on _gc_gray or _gc_marked
+	SQGCPhase _gc_phase;
+	bool _gc_incremental;			//scan marked objects through _gc_gray instead of recursively
+	sqvector<SQCollectable *> _gc_gray;	//marked objects whose references are not scanned yet
+	SQCollectable *_gc_marked;		//the reachable objects found so far
+	SQCollectable *_gc_cursor;		//next object to finalize
+	SQCollectable *_gc_scanning;	//marked object whose references are being scanned
+	SQInteger _gc_collected;		//objects finalized by the running or last collection
 #endif
 	SQObjectPtr _root_vm;
 	SQObjectPtr _table_default_delegate;
@@ -104,6 +132,9 @@ public:
 	bool _debuginfo;
 	bool _notifyallexceptions;
 private:
+#ifndef NO_GARBAGE_COLLECTOR
+	void MarkRoots(SQCollectable **chain);
+#endif
 	SQChar *_scratchpad;
 	SQInteger _scratchpadsize;
 };
@@ -45,7 +45,7 @@ private:
 public:
 	static SQTable* Create(SQSharedState *ss,SQInteger nInitialSize)
 	{
-		SQTable *newtable = (SQTable*)SQ_MALLOC(sizeof(SQTable));
+		SQTable *newtable = sq_pool_new(ss, SQTable);
 		new (newtable) SQTable(ss, nInitialSize);
 		newtable->_delegate = NULL;
 		return newtable;
@@ -83,7 +83,7 @@ public:
 	void Clear();
 	void Release()
 	{
-		sq_delete(this, SQTable);
+		sq_pool_delete(this, SQTable);
 	}
 
 };
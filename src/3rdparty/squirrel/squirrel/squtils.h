@@ -12,6 +12,33 @@ void sq_vm_free(void *p,SQUnsignedInteger size);
 #define SQ_FREE(__ptr,__size) sq_vm_free((__ptr),(__size));
 #define SQ_REALLOC(__ptr,__oldsize,__size) sq_vm_realloc((__ptr),(__oldsize),(__size));
 
+//size class pool for the small objects of a VM (tables, arrays, closures)
+//blocks are only returned to the system when the shared state is destroyed
+struct SQAllocPool
+{
+	SQAllocPool();
+	~SQAllocPool();
+	void *Alloc(SQUnsignedInteger size);
+	void Free(void *p,SQUnsignedInteger size);
+
+	SQUnsignedInteger _allocs;		//number of allocations served by the pool
+	SQUnsignedInteger _bytes_used;	//bytes currently handed out by the pool
+	SQUnsignedInteger _bytes_reserved;	//bytes obtained from the system for the pool
+private:
+	enum {
+		GRANULE = 16,		//size difference between two classes, also the alignment
+		NUM_CLASSES = 16,	//so the largest pooled size is 256 bytes
+		CHUNK_SIZE = 16384,	//size of a block of memory obtained from the system
+	};
+	void *_free[NUM_CLASSES];	//free list per size class
+	void *_chunks;			//all chunks, linked through their first word
+	char *_cur;				//bump allocation pointer in the current chunk
+	char *_end;				//end of the current chunk
+};
+
+#define sq_pool_new(__ss,__type) ((__type *)(__ss)->_pool.Alloc(sizeof(__type)))
+#define sq_pool_delete(__ptr,__type) {SQSharedState *__ss=(__ptr)->_sharedstate;(__ptr)->~__type();__ss->_pool.Free((__ptr),sizeof(__type));}
+
 //sqvector mini vector class, supports objects by value
 template<typename T> class sqvector
 {
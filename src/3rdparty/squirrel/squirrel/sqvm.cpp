@@ -115,6 +115,7 @@ SQVM::SQVM(SQSharedState *ss)
 	_can_suspend = false;
 	_in_stackoverflow = false;
 	_ops_till_suspend = 0;
+	_ops_total = 0;
 	_callsstack = NULL;
 	_callsstacksize = 0;
 	_alloccallsstacksize = 0;
@@ -468,12 +469,12 @@ bool SQVM::DerefInc(SQInteger op,SQObjectPtr &target, SQObjectPtr &self, SQObjec
 	return true;
 }
 
-#define arg0 (_i_._arg0)
-#define arg1 (_i_._arg1)
-#define sarg1 (*(const_cast<SQInt32 *>(&_i_._arg1)))
-#define arg2 (_i_._arg2)
-#define arg3 (_i_._arg3)
-#define sarg3 ((SQInteger)*((const signed char *)&_i_._arg3))
+#define arg0 (_i_->_arg0)
+#define arg1 (_i_->_arg1)
+#define sarg1 (*(const_cast<SQInt32 *>(&_i_->_arg1)))
+#define arg2 (_i_->_arg2)
+#define arg3 (_i_->_arg3)
+#define sarg3 ((SQInteger)*((const signed char *)&_i_->_arg3))
 
 SQRESULT SQVM::Suspend()
 {
@@ -573,6 +574,26 @@ bool SQVM::DELEGATE_OP(SQObjectPtr &trg,SQObjectPtr &o1,SQObjectPtr &o2)
 
 #define SQ_THROW() { goto exception_trap; }
 
+/* Dispatch through a table of label addresses when the compiler supports it (GCC and clang);
+ * every opcode then ends with its own indirect jump, which branch predictors handle far
+ * better than the single jump of the switch. Other compilers use the plain switch. */
+#if defined(__GNUC__) && !defined(SQ_NO_COMPUTED_GOTO)
+#define SQ_COMPUTED_GOTO
+#endif
+
+#ifdef SQ_COMPUTED_GOTO
+#define SQ_CASE(op) case op: sq_op##op
+#define SQ_NEXT() do { \
+		DecreaseOps(1); \
+		if (ShouldSuspend()) { _suspended = SQTrue; _suspended_traps = traps; return true; } \
+		_i_ = ci->_ip++; \
+		goto *(_i_->op <= _OP_SCOPE_END ? _dispatch_table[_i_->op] : &&sq_next_instruction); \
+	} while (0)
+#else
+#define SQ_CASE(op) case op
+#define SQ_NEXT() continue
+#endif
+
 bool SQVM::CLOSURE_OP(SQObjectPtr &target, SQFunctionProto *func)
 {
 	SQInteger nouters;
@@ -701,6 +722,73 @@ bool SQVM::Execute(SQObjectPtr &closure, SQInteger target, SQInteger nargs, SQIn
 	SQInteger ct_target;
 	SQInteger ct_stackbase;
 	bool ct_tailcall;
+	const SQInstruction *_i_;
+#ifdef SQ_COMPUTED_GOTO
+	static const void * const _dispatch_table[] = {
+		&&sq_op_OP_LINE,
+		&&sq_op_OP_LOAD,
+		&&sq_op_OP_LOADINT,
+		&&sq_op_OP_LOADFLOAT,
+		&&sq_op_OP_DLOAD,
+		&&sq_op_OP_TAILCALL,
+		&&sq_op_OP_CALL,
+		&&sq_op_OP_PREPCALL,
+		&&sq_op_OP_PREPCALLK,
+		&&sq_op_OP_GETK,
+		&&sq_op_OP_MOVE,
+		&&sq_op_OP_NEWSLOT,
+		&&sq_op_OP_DELETE,
+		&&sq_op_OP_SET,
+		&&sq_op_OP_GET,
+		&&sq_op_OP_EQ,
+		&&sq_op_OP_NE,
+		&&sq_op_OP_ARITH,
+		&&sq_op_OP_BITW,
+		&&sq_op_OP_RETURN,
+		&&sq_op_OP_LOADNULLS,
+		&&sq_op_OP_LOADROOTTABLE,
+		&&sq_op_OP_LOADBOOL,
+		&&sq_op_OP_DMOVE,
+		&&sq_op_OP_JMP,
+		&&sq_op_OP_JNZ,
+		&&sq_op_OP_JZ,
+		&&sq_op_OP_LOADFREEVAR,
+		&&sq_op_OP_VARGC,
+		&&sq_op_OP_GETVARGV,
+		&&sq_op_OP_NEWTABLE,
+		&&sq_op_OP_NEWARRAY,
+		&&sq_op_OP_APPENDARRAY,
+		&&sq_op_OP_GETPARENT,
+		&&sq_op_OP_COMPARITH,
+		&&sq_op_OP_COMPARITHL,
+		&&sq_op_OP_INC,
+		&&sq_op_OP_INCL,
+		&&sq_op_OP_PINC,
+		&&sq_op_OP_PINCL,
+		&&sq_op_OP_CMP,
+		&&sq_op_OP_EXISTS,
+		&&sq_op_OP_INSTANCEOF,
+		&&sq_op_OP_AND,
+		&&sq_op_OP_OR,
+		&&sq_op_OP_NEG,
+		&&sq_op_OP_NOT,
+		&&sq_op_OP_BWNOT,
+		&&sq_op_OP_CLOSURE,
+		&&sq_op_OP_YIELD,
+		&&sq_op_OP_RESUME,
+		&&sq_op_OP_FOREACH,
+		&&sq_op_OP_POSTFOREACH,
+		&&sq_op_OP_DELEGATE,
+		&&sq_op_OP_CLONE,
+		&&sq_op_OP_TYPEOF,
+		&&sq_op_OP_PUSHTRAP,
+		&&sq_op_OP_POPTRAP,
+		&&sq_op_OP_THROW,
+		&&sq_op_OP_CLASS,
+		&&sq_op_OP_NEWSLOTA,
+		&&sq_op_OP_SCOPE_END,
+	};
+#endif
 
 	switch(et) {
 		case ET_CALL: {
@@ -746,20 +834,20 @@ exception_restore:
 			DecreaseOps(1);
 			if (ShouldSuspend()) { _suspended = SQTrue; _suspended_traps = traps; return true; }
 
-			const SQInstruction &_i_ = *ci->_ip++;
+			_i_ = ci->_ip++;
 			//dumpstack(_stackbase);
-			//printf("%s %d %d %d %d\n",g_InstrDesc[_i_.op].name,arg0,arg1,arg2,arg3);
-			switch(_i_.op)
+			//printf("%s %d %d %d %d\n",g_InstrDesc[_i_->op].name,arg0,arg1,arg2,arg3);
+			switch(_i_->op)
 			{
-			case _OP_LINE:
+			SQ_CASE(_OP_LINE):
 				if(type(_debughook) != OT_NULL && _rawval(_debughook) != _rawval(ci->_closure))
 					CallDebugHook('l',arg1);
-				continue;
-			case _OP_LOAD: TARGET = ci->_literals[arg1]; continue;
-			case _OP_LOADINT: TARGET = (SQInteger)arg1; continue;
-			case _OP_LOADFLOAT: TARGET = *((const SQFloat *)&arg1); continue;
-			case _OP_DLOAD: TARGET = ci->_literals[arg1]; STK(arg2) = ci->_literals[arg3];continue;
-			case _OP_TAILCALL:
+				SQ_NEXT();
+			SQ_CASE(_OP_LOAD): TARGET = ci->_literals[arg1]; SQ_NEXT();
+			SQ_CASE(_OP_LOADINT): TARGET = (SQInteger)arg1; SQ_NEXT();
+			SQ_CASE(_OP_LOADFLOAT): TARGET = *((const SQFloat *)&arg1); SQ_NEXT();
+			SQ_CASE(_OP_DLOAD): TARGET = ci->_literals[arg1]; STK(arg2) = ci->_literals[arg3];SQ_NEXT();
+			SQ_CASE(_OP_TAILCALL):
 				temp_reg = STK(arg1);
 				if (type(temp_reg) == OT_CLOSURE && !_funcproto(_closure(temp_reg)->_function)->_bgenerator){
 					ct_tailcall = true;
@@ -770,7 +858,7 @@ exception_restore:
 					goto common_call;
 				}
 				FALLTHROUGH;
-			case _OP_CALL: {
+			SQ_CASE(_OP_CALL): {
 					ct_tailcall = false;
 					ct_target = arg0;
 					temp_reg = STK(arg1);
@@ -790,7 +878,7 @@ common_call:
 						}
 						CLEARSTACK(last_top);
 						}
-						continue;
+						SQ_NEXT();
 					case OT_NATIVECLOSURE: {
 						bool suspend;
 						_suspended_target = ct_target;
@@ -817,7 +905,7 @@ common_call:
 							STK(ct_target) = clo;
 						}
 										   }
-						continue;
+						SQ_NEXT();
 					case OT_CLASS:{
 						SQObjectPtr inst;
 						_GUARD(CreateClassInstance(_class(clo),inst,temp_reg));
@@ -847,18 +935,18 @@ common_call:
 						SQ_THROW();
 					}
 				}
-				  continue;
-			case _OP_PREPCALL:
-			case _OP_PREPCALLK:
+				  SQ_NEXT();
+			SQ_CASE(_OP_PREPCALL):
+			SQ_CASE(_OP_PREPCALLK):
 				{
-					SQObjectPtr &key = _i_.op == _OP_PREPCALLK?(ci->_literals)[arg1]:STK(arg1);
+					SQObjectPtr &key = _i_->op == _OP_PREPCALLK?(ci->_literals)[arg1]:STK(arg1);
 					SQObjectPtr &o = STK(arg2);
 					if (!Get(o, key, temp_reg,false,true)) {
 						if(type(o) == OT_CLASS) { //hack?
 							if(_class_ddel->Get(key,temp_reg)) {
 								STK(arg3) = o;
 								TARGET = temp_reg;
-								continue;
+								SQ_NEXT();
 							}
 						}
 						{ Raise_IdxError(key); SQ_THROW();}
@@ -867,8 +955,8 @@ common_call:
 					STK(arg3) = type(o) == OT_CLASS?STK(0):o;
 					TARGET = temp_reg;
 				}
-				continue;
-			case _OP_SCOPE_END:
+				SQ_NEXT();
+			SQ_CASE(_OP_SCOPE_END):
 			{
 				SQInteger from = arg0;
 				SQInteger count = arg1 - arg0 + 2;
@@ -878,38 +966,38 @@ common_call:
 				if (_stackbase + count + from <= _top) {
 					while (--count >= 0) _stack._vals[_stackbase + count + from].Null();
 				}
-			} continue;
-			case _OP_GETK:
+			} SQ_NEXT();
+			SQ_CASE(_OP_GETK):
 				if (!Get(STK(arg2), ci->_literals[arg1], temp_reg, false,true)) { Raise_IdxError(ci->_literals[arg1]); SQ_THROW();}
 				TARGET = temp_reg;
-				continue;
-			case _OP_MOVE: TARGET = STK(arg1); continue;
-			case _OP_NEWSLOT:
+				SQ_NEXT();
+			SQ_CASE(_OP_MOVE): TARGET = STK(arg1); SQ_NEXT();
+			SQ_CASE(_OP_NEWSLOT):
 				_GUARD(NewSlot(STK(arg1), STK(arg2), STK(arg3),false));
 				if(arg0 != arg3) TARGET = STK(arg3);
-				continue;
-			case _OP_DELETE: _GUARD(DeleteSlot(STK(arg1), STK(arg2), TARGET)); continue;
-			case _OP_SET:
+				SQ_NEXT();
+			SQ_CASE(_OP_DELETE): _GUARD(DeleteSlot(STK(arg1), STK(arg2), TARGET)); SQ_NEXT();
+			SQ_CASE(_OP_SET):
 				if (!Set(STK(arg1), STK(arg2), STK(arg3),true)) { Raise_IdxError(STK(arg2)); SQ_THROW(); }
 				if (arg0 != arg3) TARGET = STK(arg3);
-				continue;
-			case _OP_GET:
+				SQ_NEXT();
+			SQ_CASE(_OP_GET):
 				if (!Get(STK(arg1), STK(arg2), temp_reg, false,true)) { Raise_IdxError(STK(arg2)); SQ_THROW(); }
 				TARGET = temp_reg;
-				continue;
-			case _OP_EQ:{
+				SQ_NEXT();
+			SQ_CASE(_OP_EQ):{
 				bool res;
 				if(!IsEqual(STK(arg2),COND_LITERAL,res)) { SQ_THROW(); }
 				TARGET = res?_true_:_false_;
-				}continue;
-			case _OP_NE:{
+				}SQ_NEXT();
+			SQ_CASE(_OP_NE):{
 				bool res;
 				if(!IsEqual(STK(arg2),COND_LITERAL,res)) { SQ_THROW(); }
 				TARGET = (!res)?_true_:_false_;
-				} continue;
-			case _OP_ARITH: _GUARD(ARITH_OP( arg3 , temp_reg, STK(arg2), STK(arg1))); TARGET = temp_reg; continue;
-			case _OP_BITW:	_GUARD(BW_OP( arg3,TARGET,STK(arg2),STK(arg1))); continue;
-			case _OP_RETURN:
+				} SQ_NEXT();
+			SQ_CASE(_OP_ARITH): _GUARD(ARITH_OP( arg3 , temp_reg, STK(arg2), STK(arg1))); TARGET = temp_reg; SQ_NEXT();
+			SQ_CASE(_OP_BITW):	_GUARD(BW_OP( arg3,TARGET,STK(arg2),STK(arg1))); SQ_NEXT();
+			SQ_CASE(_OP_RETURN):
 				if(ci->_generator) {
 					ci->_generator->Kill();
 				}
@@ -918,65 +1006,65 @@ common_call:
 					outres = temp_reg;
 					return true;
 				}
-				continue;
-			case _OP_LOADNULLS:{ for(SQInt32 n=0; n < arg1; n++) STK(arg0+n) = _null_; }continue;
-			case _OP_LOADROOTTABLE:	TARGET = _roottable; continue;
-			case _OP_LOADBOOL: TARGET = arg1?_true_:_false_; continue;
-			case _OP_DMOVE: STK(arg0) = STK(arg1); STK(arg2) = STK(arg3); continue;
-			case _OP_JMP: ci->_ip += (sarg1); continue;
-			case _OP_JNZ: if(!IsFalse(STK(arg0))) ci->_ip+=(sarg1); continue;
-			case _OP_JZ: if(IsFalse(STK(arg0))) ci->_ip+=(sarg1); continue;
-			case _OP_LOADFREEVAR: TARGET = _closure(ci->_closure)->_outervalues[arg1]; continue;
-			case _OP_VARGC: TARGET = SQInteger(ci->_vargs.size); continue;
-			case _OP_GETVARGV:
+				SQ_NEXT();
+			SQ_CASE(_OP_LOADNULLS):{ for(SQInt32 n=0; n < arg1; n++) STK(arg0+n) = _null_; }SQ_NEXT();
+			SQ_CASE(_OP_LOADROOTTABLE):	TARGET = _roottable; SQ_NEXT();
+			SQ_CASE(_OP_LOADBOOL): TARGET = arg1?_true_:_false_; SQ_NEXT();
+			SQ_CASE(_OP_DMOVE): STK(arg0) = STK(arg1); STK(arg2) = STK(arg3); SQ_NEXT();
+			SQ_CASE(_OP_JMP): ci->_ip += (sarg1); SQ_NEXT();
+			SQ_CASE(_OP_JNZ): if(!IsFalse(STK(arg0))) ci->_ip+=(sarg1); SQ_NEXT();
+			SQ_CASE(_OP_JZ): if(IsFalse(STK(arg0))) ci->_ip+=(sarg1); SQ_NEXT();
+			SQ_CASE(_OP_LOADFREEVAR): TARGET = _closure(ci->_closure)->_outervalues[arg1]; SQ_NEXT();
+			SQ_CASE(_OP_VARGC): TARGET = SQInteger(ci->_vargs.size); SQ_NEXT();
+			SQ_CASE(_OP_GETVARGV):
 				if(!GETVARGV_OP(TARGET,STK(arg1),ci)) { SQ_THROW(); }
-				continue;
-			case _OP_NEWTABLE: TARGET = SQTable::Create(_ss(this), arg1); continue;
-			case _OP_NEWARRAY: TARGET = SQArray::Create(_ss(this), 0); _array(TARGET)->Reserve(arg1); continue;
-			case _OP_APPENDARRAY: _array(STK(arg0))->Append(COND_LITERAL);	continue;
-			case _OP_GETPARENT: _GUARD(GETPARENT_OP(STK(arg1),TARGET)); continue;
-			case _OP_COMPARITH: _GUARD(DerefInc(arg3, TARGET, STK((((SQUnsignedInteger)arg1&0xFFFF0000)>>16)), STK(arg2), STK(arg1&0x0000FFFF), false)); continue;
-			case _OP_COMPARITHL: _GUARD(LOCAL_INC(arg3, TARGET, STK(arg1), STK(arg2))); continue;
-			case _OP_INC: {SQObjectPtr o(sarg3); _GUARD(DerefInc('+',TARGET, STK(arg1), STK(arg2), o, false));} continue;
-			case _OP_INCL: {SQObjectPtr o(sarg3); _GUARD(LOCAL_INC('+',TARGET, STK(arg1), o));} continue;
-			case _OP_PINC: {SQObjectPtr o(sarg3); _GUARD(DerefInc('+',TARGET, STK(arg1), STK(arg2), o, true));} continue;
-			case _OP_PINCL:	{SQObjectPtr o(sarg3); _GUARD(PLOCAL_INC('+',TARGET, STK(arg1), o));} continue;
-			case _OP_CMP:	_GUARD(CMP_OP((CmpOP)arg3,STK(arg2),STK(arg1),TARGET))	continue;
-			case _OP_EXISTS: TARGET = Get(STK(arg1), STK(arg2), temp_reg, true,false)?_true_:_false_;continue;
-			case _OP_INSTANCEOF:
+				SQ_NEXT();
+			SQ_CASE(_OP_NEWTABLE): TARGET = SQTable::Create(_ss(this), arg1); SQ_NEXT();
+			SQ_CASE(_OP_NEWARRAY): TARGET = SQArray::Create(_ss(this), 0); _array(TARGET)->Reserve(arg1); SQ_NEXT();
+			SQ_CASE(_OP_APPENDARRAY): _array(STK(arg0))->Append(COND_LITERAL);	SQ_NEXT();
+			SQ_CASE(_OP_GETPARENT): _GUARD(GETPARENT_OP(STK(arg1),TARGET)); SQ_NEXT();
+			SQ_CASE(_OP_COMPARITH): _GUARD(DerefInc(arg3, TARGET, STK((((SQUnsignedInteger)arg1&0xFFFF0000)>>16)), STK(arg2), STK(arg1&0x0000FFFF), false)); SQ_NEXT();
+			SQ_CASE(_OP_COMPARITHL): _GUARD(LOCAL_INC(arg3, TARGET, STK(arg1), STK(arg2))); SQ_NEXT();
+			SQ_CASE(_OP_INC): {SQObjectPtr o(sarg3); _GUARD(DerefInc('+',TARGET, STK(arg1), STK(arg2), o, false));} SQ_NEXT();
+			SQ_CASE(_OP_INCL): {SQObjectPtr o(sarg3); _GUARD(LOCAL_INC('+',TARGET, STK(arg1), o));} SQ_NEXT();
+			SQ_CASE(_OP_PINC): {SQObjectPtr o(sarg3); _GUARD(DerefInc('+',TARGET, STK(arg1), STK(arg2), o, true));} SQ_NEXT();
+			SQ_CASE(_OP_PINCL):	{SQObjectPtr o(sarg3); _GUARD(PLOCAL_INC('+',TARGET, STK(arg1), o));} SQ_NEXT();
+			SQ_CASE(_OP_CMP):	_GUARD(CMP_OP((CmpOP)arg3,STK(arg2),STK(arg1),TARGET))	SQ_NEXT();
+			SQ_CASE(_OP_EXISTS): TARGET = Get(STK(arg1), STK(arg2), temp_reg, true,false)?_true_:_false_;SQ_NEXT();
+			SQ_CASE(_OP_INSTANCEOF):
 				if(type(STK(arg1)) != OT_CLASS || type(STK(arg2)) != OT_INSTANCE)
 				{Raise_Error("cannot apply instanceof between a %s and a %s",GetTypeName(STK(arg1)),GetTypeName(STK(arg2))); SQ_THROW();}
 				TARGET = _instance(STK(arg2))->InstanceOf(_class(STK(arg1)))?_true_:_false_;
-				continue;
-			case _OP_AND:
+				SQ_NEXT();
+			SQ_CASE(_OP_AND):
 				if(IsFalse(STK(arg2))) {
 					TARGET = STK(arg2);
 					ci->_ip += (sarg1);
 				}
-				continue;
-			case _OP_OR:
+				SQ_NEXT();
+			SQ_CASE(_OP_OR):
 				if(!IsFalse(STK(arg2))) {
 					TARGET = STK(arg2);
 					ci->_ip += (sarg1);
 				}
-				continue;
-			case _OP_NEG: _GUARD(NEG_OP(TARGET,STK(arg1))); continue;
-			case _OP_NOT: TARGET = (IsFalse(STK(arg1))?_true_:_false_); continue;
-			case _OP_BWNOT:
+				SQ_NEXT();
+			SQ_CASE(_OP_NEG): _GUARD(NEG_OP(TARGET,STK(arg1))); SQ_NEXT();
+			SQ_CASE(_OP_NOT): TARGET = (IsFalse(STK(arg1))?_true_:_false_); SQ_NEXT();
+			SQ_CASE(_OP_BWNOT):
 				if(type(STK(arg1)) == OT_INTEGER) {
 					SQInteger t = _integer(STK(arg1));
 					TARGET = SQInteger(~t);
-					continue;
+					SQ_NEXT();
 				}
 				Raise_Error("attempt to perform a bitwise op on a %s", GetTypeName(STK(arg1)));
 				SQ_THROW();
-			case _OP_CLOSURE: {
+			SQ_CASE(_OP_CLOSURE): {
 				SQClosure *c = ci->_closure._unVal.pClosure;
 				SQFunctionProto *fp = c->_function._unVal.pFunctionProto;
 				if(!CLOSURE_OP(TARGET,fp->_functions[arg1]._unVal.pFunctionProto)) { SQ_THROW(); }
-				continue;
+				SQ_NEXT();
 			}
-			case _OP_YIELD:{
+			SQ_CASE(_OP_YIELD):{
 				if(ci->_generator) {
 					if(sarg1 != MAX_FUNC_STACKSIZE) temp_reg = STK(arg1);
 					_GUARD(ci->_generator->Yield(this));
@@ -991,43 +1079,43 @@ common_call:
 				}
 
 				}
-				continue;
-			case _OP_RESUME:
+				SQ_NEXT();
+			SQ_CASE(_OP_RESUME):
 				if(type(STK(arg1)) != OT_GENERATOR){ Raise_Error("trying to resume a '%s',only genenerator can be resumed", GetTypeName(STK(arg1))); SQ_THROW();}
 				_GUARD(_generator(STK(arg1))->Resume(this, arg0));
 				traps += ci->_etraps;
-                continue;
-			case _OP_FOREACH:{ int tojump;
+                SQ_NEXT();
+			SQ_CASE(_OP_FOREACH):{ int tojump;
 				_GUARD(FOREACH_OP(STK(arg0),STK(arg2),STK(arg2+1),STK(arg2+2),arg2,sarg1,tojump));
 				ci->_ip += tojump; }
-				continue;
-			case _OP_POSTFOREACH:
+				SQ_NEXT();
+			SQ_CASE(_OP_POSTFOREACH):
 				assert(type(STK(arg0)) == OT_GENERATOR);
 				if(_generator(STK(arg0))->_state == SQGenerator::eDead)
 					ci->_ip += (sarg1 - 1);
-				continue;
-			case _OP_DELEGATE: _GUARD(DELEGATE_OP(TARGET,STK(arg1),STK(arg2))); continue;
-			case _OP_CLONE:
+				SQ_NEXT();
+			SQ_CASE(_OP_DELEGATE): _GUARD(DELEGATE_OP(TARGET,STK(arg1),STK(arg2))); SQ_NEXT();
+			SQ_CASE(_OP_CLONE):
 				if(!Clone(STK(arg1), TARGET))
 				{ Raise_Error("cloning a %s", GetTypeName(STK(arg1))); SQ_THROW();}
-				continue;
-			case _OP_TYPEOF: TypeOf(STK(arg1), TARGET); continue;
-			case _OP_PUSHTRAP:{
+				SQ_NEXT();
+			SQ_CASE(_OP_TYPEOF): TypeOf(STK(arg1), TARGET); SQ_NEXT();
+			SQ_CASE(_OP_PUSHTRAP):{
 				SQInstruction *_iv = _funcproto(_closure(ci->_closure)->_function)->_instructions;
 				_etraps.push_back(SQExceptionTrap(_top,_stackbase, &_iv[(ci->_ip-_iv)+arg1], arg0)); traps++;
 				ci->_etraps++;
 							  }
-				continue;
-			case _OP_POPTRAP: {
+				SQ_NEXT();
+			SQ_CASE(_OP_POPTRAP): {
 				for(SQInteger i = 0; i < arg0; i++) {
 					_etraps.pop_back(); traps--;
 					ci->_etraps--;
 				}
 							  }
-				continue;
-			case _OP_THROW:	Raise_Error(TARGET); SQ_THROW();
-			case _OP_CLASS: _GUARD(CLASS_OP(TARGET,arg1,arg2)); continue;
-			case _OP_NEWSLOTA:
+				SQ_NEXT();
+			SQ_CASE(_OP_THROW):	Raise_Error(TARGET); SQ_THROW();
+			SQ_CASE(_OP_CLASS): _GUARD(CLASS_OP(TARGET,arg1,arg2)); SQ_NEXT();
+			SQ_CASE(_OP_NEWSLOTA):
 				bool bstatic = (arg0&NEW_SLOT_STATIC_FLAG)?true:false;
 				if(type(STK(arg1)) == OT_CLASS) {
 					if(type(_class(STK(arg1))->_metamethods[MT_NEWMEMBER]) != OT_NULL ) {
@@ -1037,7 +1125,7 @@ common_call:
 						int nparams = 5;
 						if(Call(_class(STK(arg1))->_metamethods[MT_NEWMEMBER], nparams, _top - nparams, temp_reg,SQFalse,SQFalse)) {
 							Pop(nparams);
-							continue;
+							SQ_NEXT();
 						}
 					}
 				}
@@ -1045,9 +1133,12 @@ common_call:
 				if((arg0&NEW_SLOT_ATTRIBUTES_FLAG)) {
 					_class(STK(arg1))->SetAttributes(STK(arg2),STK(arg2-1));
 				}
-				continue;
+				SQ_NEXT();
 			}
-
+#ifdef SQ_COMPUTED_GOTO
+sq_next_instruction:
+			;
+#endif
 		}
 	}
 exception_trap:
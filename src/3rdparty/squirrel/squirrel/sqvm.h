@@ -170,6 +170,7 @@ public:
 
 	SQBool _can_suspend;
 	SQInteger _ops_till_suspend;
+	SQUnsignedInteger _ops_total; //all operations executed or charged, for profiling
 	SQBool _in_stackoverflow;
 
 	bool ShouldSuspend()
@@ -179,6 +180,7 @@ public:
 
 	void DecreaseOps(SQInteger amount)
 	{
+		_ops_total += amount;
 		if (_ops_till_suspend - amount < _ops_till_suspend) _ops_till_suspend -= amount;
 	}
 };
@@ -19,12 +19,17 @@
 #include "../framerate_type.h"
 #include "../scope_info.h"
 #include "../string_func.h"
+#include "../settings_type.h"
+#include "../worker_thread_pool.h"
+#include "../script/squirrel.hpp"
 #include "ai_scanner.hpp"
 #include "ai_instance.hpp"
 #include "ai_config.hpp"
 #include "ai_info.hpp"
 #include "ai.hpp"
 
+#include <vector>
+
 #include "../safeguards.h"
 
 /* static */ uint AI::frame_counter = 0;
@@ -68,6 +73,19 @@
 	return;
 }
 
+/**
+ * Run the script of an AI company for one tick on a thread of the worker thread pool.
+ * @param c The AI company.
+ * @param turn Position of the AI in the order in which the AIs access the game.
+ */
+static void RunAIOnWorkerThread(const Company *c, uint turn)
+{
+	PerformanceMeasurer framerate((PerformanceElement)(PFE_AI0 + c->index));
+	Squirrel::EnterWorkerThread(c->index, turn);
+	c->ai_instance->GameLoop();
+	Squirrel::LeaveWorkerThread();
+}
+
 /* static */ void AI::GameLoop()
 {
 	/* If we are in networking, only servers run this function, and that only if it is allowed */
@@ -80,14 +98,32 @@
 
 	Backup<CompanyByte> cur_company(_current_company, FILE_LINE);
 	const Company *c;
-	FOR_ALL_COMPANIES(c) {
-		if (c->is_ai) {
-			SCOPE_INFO_FMT([&], "AI::GameLoop: %i: %s (v%d)\n", (int)c->index, c->ai_info->GetName(), c->ai_info->GetVersion());
-			PerformanceMeasurer framerate((PerformanceElement)(PFE_AI0 + c->index));
-			cur_company.Change(c->index);
-			c->ai_instance->GameLoop();
-		} else {
-			PerformanceMeasurer::SetInactive((PerformanceElement)(PFE_AI0 + c->index));
+	if (_settings_game.script.script_worker_threads) {
+		std::vector<const Company *> ais;
+		FOR_ALL_COMPANIES(c) {
+			if (c->is_ai) {
+				ais.push_back(c);
+			} else {
+				PerformanceMeasurer::SetInactive((PerformanceElement)(PFE_AI0 + c->index));
+			}
+		}
+
+		/* The scripts run in parallel, the main thread taking its share. Their
+		 * calls into the game, commands included, are made in company order:
+		 * a script only gets into the game once all AIs before it are done,
+		 * so the outcome is the same as without threads. */
+		Squirrel::ResetWorkerTurns();
+		_worker_thread_pool.Run((uint)ais.size(), [&ais](uint i) { RunAIOnWorkerThread(ais[i], i); });
+	} else {
+		FOR_ALL_COMPANIES(c) {
+			if (c->is_ai) {
+				SCOPE_INFO_FMT([&], "AI::GameLoop: %i: %s (v%d)\n", (int)c->index, c->ai_info->GetName(), c->ai_info->GetVersion());
+				PerformanceMeasurer framerate((PerformanceElement)(PFE_AI0 + c->index));
+				cur_company.Change(c->index);
+				c->ai_instance->GameLoop();
+			} else {
+				PerformanceMeasurer::SetInactive((PerformanceElement)(PFE_AI0 + c->index));
+			}
 		}
 	}
 	cur_company.Restore();
@@ -1202,6 +1202,24 @@ struct AIDebugWindow : public Window {
 					SetDParam(2, info->GetVersion());
 				}
 				break;
+
+			case WID_AID_PROFILE: {
+				if (!this->IsValidDebugCompany(ai_debug_company)) {
+					SetDParam(0, STR_EMPTY);
+					break;
+				}
+				const ScriptInstance *instance = (ai_debug_company == OWNER_DEITY) ? (const ScriptInstance *)Game::GetInstance() : Company::Get(ai_debug_company)->ai_instance;
+				SquirrelProfile profile = instance->GetProfile();
+				SetDParam(0, STR_AI_DEBUG_PROFILE);
+				SetDParam(1, profile.ops);
+				SetDParam(2, profile.allocations);
+				SetDParam(3, profile.pool_bytes);
+				SetDParam(4, profile.gc_runs);
+				SetDParam(5, profile.gc_time / 1000);
+				SetDParam(6, profile.gc_max_pause);
+				SetDParam(7, profile.gc_collected);
+				break;
+			}
 		}
 	}
 
@@ -1411,6 +1429,12 @@ struct AIDebugWindow : public Window {
 		this->vscroll->SetCapacityFromWidget(this, WID_AID_LOG_PANEL);
 	}
 
+	void OnHundredthTick() override
+	{
+		/* The profiling counters change all the time; refreshing them now and then is enough. */
+		this->SetWidgetDirty(WID_AID_PROFILE);
+	}
+
 	static HotkeyList hotkeys;
 };
 
@@ -1505,6 +1529,10 @@ static const NWidgetPart _nested_ai_debug_widgets[] = {
 					NWidget(WWT_PUSHTXTBTN, COLOUR_GREY, WID_AID_CONTINUE_BTN), SetMinimalSize(100, 0), SetFill(0, 1), SetDataTip(STR_AI_DEBUG_CONTINUE, STR_AI_DEBUG_CONTINUE_TOOLTIP),
 				EndContainer(),
 			EndContainer(),
+			/* Profiling counters */
+			NWidget(WWT_PANEL, COLOUR_GREY),
+				NWidget(WWT_TEXT, COLOUR_GREY, WID_AID_PROFILE), SetFill(1, 0), SetResize(1, 0), SetPadding(2, 2, 2, 4), SetDataTip(STR_JUST_STRING, STR_AI_DEBUG_PROFILE_TOOLTIP),
+			EndContainer(),
 		EndContainer(),
 		NWidget(NWID_VERTICAL),
 			NWidget(NWID_VSCROLLBAR, COLOUR_GREY, WID_AID_SCROLLBAR),
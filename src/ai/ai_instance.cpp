@@ -190,6 +190,7 @@ void AIInstance::RegisterAPI()
 	SQAITileList_Register(this->engine);
 	SQAITileList_IndustryAccepting_Register(this->engine);
 	SQAITileList_IndustryProducing_Register(this->engine);
+	SQAITileList_Property_Register(this->engine);
 	SQAITileList_StationType_Register(this->engine);
 	SQAITown_Register(this->engine);
 	SQAITownEffectList_Register(this->engine);
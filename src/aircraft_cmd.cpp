@@ -1395,6 +1395,7 @@ static void MaybeCrashAirplane(Aircraft *v)
 		st->goods[i].rating = 1;
 		st->goods[i].cargo.Truncate();
 	}
+	st->rating_cargoes = ALL_CARGOTYPES;
 
 	CrashAirplane(v);
 }
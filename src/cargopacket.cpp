@@ -20,9 +20,9 @@
 #include "core/backup_type.hpp"
 #include "string_func.h"
 #include "strings_func.h"
-#include "3rdparty/cpp-btree/btree_map.h"
 
 #include <vector>
+#include <chrono>
 
 #include "safeguards.h"
 
@@ -30,57 +30,194 @@
 CargoPacketPool _cargopacket_pool("CargoPacket");
 INSTANTIATE_POOL_METHODS(CargoPacket)
 
-btree::btree_map<uint64, Money> _cargo_packet_deferred_payments;
+std::vector<CargoPacketDeferredPaymentBlock> _cargo_packet_deferred_payment_blocks;
+uint _cargo_packet_deferred_payment_count = 0;
+static uint32 _cargo_packet_deferred_payment_free_block = INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK; ///< First block of the free list.
+static uint _cargo_packet_deferred_payment_free_count = 0; ///< Number of blocks in the free list.
 
 void ClearCargoPacketDeferredPayments() {
-	_cargo_packet_deferred_payments.clear();
+	_cargo_packet_deferred_payment_blocks.clear();
+	_cargo_packet_deferred_payment_blocks.shrink_to_fit();
+	_cargo_packet_deferred_payment_count = 0;
+	_cargo_packet_deferred_payment_free_block = INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK;
+	_cargo_packet_deferred_payment_free_count = 0;
 }
 
-void ChangeOwnershipOfCargoPacketDeferredPayments(Owner old_owner, Owner new_owner)
+static inline uint16 CargoPacketDeferredPaymentSlotKey(CompanyID cid, VehicleType type)
 {
-	std::vector<std::pair<uint64, Money>> to_merge;
-	auto iter = _cargo_packet_deferred_payments.begin();
-	while (iter != _cargo_packet_deferred_payments.end()) {
-		uint64 k = iter->first;
-		if ((CompanyID) GB(k, 24, 8) == old_owner) {
-			if (new_owner != INVALID_OWNER) {
-				SB(k, 24, 8, new_owner);
-				to_merge.push_back({ k, iter->second });
-			}
-			iter = _cargo_packet_deferred_payments.erase(iter);
-		} else {
-			++iter;
-		}
+	return (cid << 2) | type;
+}
+
+/**
+ * Get an empty deferred payment block, from the free list if possible.
+ * @return Index of the block.
+ * @note This invalidates references to other blocks.
+ */
+static uint32 AllocateCargoPacketDeferredPaymentBlock()
+{
+	uint32 index = _cargo_packet_deferred_payment_free_block;
+	if (index != INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK) {
+		_cargo_packet_deferred_payment_free_block = _cargo_packet_deferred_payment_blocks[index].next;
+		_cargo_packet_deferred_payment_free_count--;
+	} else {
+		index = (uint32) _cargo_packet_deferred_payment_blocks.size();
+		_cargo_packet_deferred_payment_blocks.emplace_back();
 	}
-	for (auto &m : to_merge) {
-		_cargo_packet_deferred_payments[m.first] += m.second;
+	CargoPacketDeferredPaymentBlock &b = _cargo_packet_deferred_payment_blocks[index];
+	b.used = 0;
+	b.next = INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK;
+	return index;
+}
+
+/**
+ * Move a chain of deferred payment blocks to the free list.
+ * @param block First block of the chain.
+ */
+static void FreeCargoPacketDeferredPaymentBlocks(uint32 block)
+{
+	while (block != INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK) {
+		CargoPacketDeferredPaymentBlock &b = _cargo_packet_deferred_payment_blocks[block];
+		uint32 next = b.next;
+		_cargo_packet_deferred_payment_count -= b.used;
+		b.used = 0;
+		b.next = _cargo_packet_deferred_payment_free_block;
+		_cargo_packet_deferred_payment_free_block = block;
+		_cargo_packet_deferred_payment_free_count++;
+		block = next;
 	}
 }
 
-inline uint64 CargoPacketDeferredPaymentKey(CargoPacketID id, CompanyID cid, VehicleType type)
+/**
+ * Insert a zero payment into a chain of deferred payment blocks, moving the following payments one slot further.
+ * @param block Block to insert into.
+ * @param slot Slot to insert at.
+ * @param key Key of the new payment.
+ */
+static void InsertCargoPacketDeferredPaymentSlot(uint32 block, uint slot, uint16 key)
 {
-	return (((uint64) id) << 32) | (cid << 24) | (type << 22);
+	/* Make sure there is a free slot at the end before taking any references. */
+	uint32 last = block;
+	while (_cargo_packet_deferred_payment_blocks[last].next != INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK) last = _cargo_packet_deferred_payment_blocks[last].next;
+	if (_cargo_packet_deferred_payment_blocks[last].used == CargoPacketDeferredPaymentBlock::SLOTS) {
+		uint32 new_block = AllocateCargoPacketDeferredPaymentBlock();
+		_cargo_packet_deferred_payment_blocks[last].next = new_block;
+	}
+
+	uint16 carry_key = key;
+	Money carry_payment = 0;
+	for (; block != INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK; block = _cargo_packet_deferred_payment_blocks[block].next, slot = 0) {
+		CargoPacketDeferredPaymentBlock &b = _cargo_packet_deferred_payment_blocks[block];
+		for (; slot < b.used; slot++) {
+			std::swap(b.key[slot], carry_key);
+			std::swap(b.payment[slot], carry_payment);
+		}
+		if (b.used < CargoPacketDeferredPaymentBlock::SLOTS) {
+			b.key[b.used] = carry_key;
+			b.payment[b.used] = carry_payment;
+			b.used++;
+			break;
+		}
+	}
+	_cargo_packet_deferred_payment_count++;
 }
 
-template <typename F>
-inline void IterateCargoPacketDeferredPayments(CargoPacketID index, bool erase_range, F functor)
+/**
+ * Get a deferred payment of a chain of blocks, adding a zero payment if there is none yet.
+ * @param head First block of the chain, updated if the chain was empty.
+ * @param key Company and vehicle type of the payment.
+ * @return Reference to the payment, valid until the next payment is added.
+ */
+static Money &GetCargoPacketDeferredPayment(uint32 &head, uint16 key)
 {
-	auto start_iter = _cargo_packet_deferred_payments.lower_bound(CargoPacketDeferredPaymentKey(index, (CompanyID) 0, (VehicleType) 0));
-	auto iter = start_iter;
-	for (; iter != _cargo_packet_deferred_payments.end() && iter->first >> 32 == index; ++iter) {
-		functor(iter->second, (CompanyID) GB(iter->first, 24, 8), (VehicleType) GB(iter->first, 22, 2));
+	uint32 last = INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK;
+	for (uint32 block = head; block != INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK; block = _cargo_packet_deferred_payment_blocks[block].next) {
+		CargoPacketDeferredPaymentBlock &b = _cargo_packet_deferred_payment_blocks[block];
+		for (uint slot = 0; slot < b.used; slot++) {
+			if (b.key[slot] == key) return b.payment[slot];
+			if (b.key[slot] > key) {
+				InsertCargoPacketDeferredPaymentSlot(block, slot, key);
+				return _cargo_packet_deferred_payment_blocks[block].payment[slot];
+			}
+		}
+		last = block;
 	}
+
+	/* All present payments sort before the new one, append it. */
+	if (last == INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK || _cargo_packet_deferred_payment_blocks[last].used == CargoPacketDeferredPaymentBlock::SLOTS) {
+		uint32 new_block = AllocateCargoPacketDeferredPaymentBlock();
+		if (last == INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK) {
+			head = new_block;
+		} else {
+			_cargo_packet_deferred_payment_blocks[last].next = new_block;
+		}
+		last = new_block;
+	}
+	CargoPacketDeferredPaymentBlock &b = _cargo_packet_deferred_payment_blocks[last];
+	b.key[b.used] = key;
+	b.payment[b.used] = 0;
+	_cargo_packet_deferred_payment_count++;
+	return b.payment[b.used++];
+}
+
+template <typename F>
+inline void IterateCargoPacketDeferredPayments(uint32 &head, bool erase_range, F functor)
+{
+	IterateCargoPacketDeferredPaymentBlocks(head, functor);
 	if (erase_range) {
-		_cargo_packet_deferred_payments.erase(start_iter, iter);
+		FreeCargoPacketDeferredPaymentBlocks(head);
+		head = INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK;
+	}
+}
+
+void ChangeOwnershipOfCargoPacketDeferredPayments(Owner old_owner, Owner new_owner)
+{
+	std::vector<std::pair<uint16, Money>> payments;
+	CargoPacket *cp;
+	FOR_ALL_CARGOPACKETS(cp) {
+		if (cp->deferred_payments == INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK) continue;
+
+		bool found = false;
+		payments.clear();
+		IterateCargoPacketDeferredPayments(cp->deferred_payments, false, [&](Money &payment, CompanyID cid, VehicleType type) {
+			payments.push_back({ CargoPacketDeferredPaymentSlotKey(cid, type), payment });
+			if (cid == old_owner) found = true;
+		});
+		if (!found) continue;
+
+		/* Rebuild the chain, the payments of the old owner are merged into those of the new one. */
+		FreeCargoPacketDeferredPaymentBlocks(cp->deferred_payments);
+		cp->deferred_payments = INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK;
+		for (auto &m : payments) {
+			if ((CompanyID) GB(m.first, 2, 8) != old_owner) GetCargoPacketDeferredPayment(cp->deferred_payments, m.first) += m.second;
+		}
+		if (new_owner != INVALID_OWNER) {
+			for (auto &m : payments) {
+				if ((CompanyID) GB(m.first, 2, 8) == old_owner) GetCargoPacketDeferredPayment(cp->deferred_payments, CargoPacketDeferredPaymentSlotKey(new_owner, (VehicleType) GB(m.first, 0, 2))) += m.second;
+			}
+		}
 	}
 }
 
 void DumpCargoPacketDeferredPaymentStats(char *buffer, const char *last)
 {
 	Money payments[256][4] = {};
-	for (auto &it : _cargo_packet_deferred_payments) {
-		payments[GB(it.first, 24, 8)][GB(it.first, 22, 2)] += it.second;
+	uint packets = 0;
+	uint max_packet_payments = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	const CargoPacket *cp;
+	FOR_ALL_CARGOPACKETS(cp) {
+		uint packet_payments = 0;
+		cp->IterateDeferredPayments([&](Money payment, CompanyID cid, VehicleType type) {
+			payments[cid][type] += payment;
+			packet_payments++;
+		});
+		if (packet_payments > 0) {
+			packets++;
+			max_packet_payments = max(max_packet_payments, packet_payments);
+		}
 	}
+	uint64 scan_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
 	for (uint i = 0; i < 256; i++) {
 		for (uint j = 0; j < 4; j++) {
 			if (payments[i][j] != 0) {
@@ -95,7 +232,12 @@ void DumpCargoPacketDeferredPaymentStats(char *buffer, const char *last)
 			}
 		}
 	}
-	buffer += seprintf(buffer, last, "Deferred payment count: %u\n", (uint) _cargo_packet_deferred_payments.size());
+	buffer += seprintf(buffer, last, "Deferred payment count: %u\n", _cargo_packet_deferred_payment_count);
+	buffer += seprintf(buffer, last, "Cargo packets with deferred payments: %u, most payments of one packet: %u\n", packets, max_packet_payments);
+	buffer += seprintf(buffer, last, "Deferred payment blocks: %u used, %u free, %u payments per block, " PRINTF_SIZE " bytes allocated\n",
+			(uint) _cargo_packet_deferred_payment_blocks.size() - _cargo_packet_deferred_payment_free_count, _cargo_packet_deferred_payment_free_count,
+			CargoPacketDeferredPaymentBlock::SLOTS, _cargo_packet_deferred_payment_blocks.capacity() * sizeof(CargoPacketDeferredPaymentBlock));
+	buffer += seprintf(buffer, last, "Time to scan all cargo packets: " OTTD_PRINTF64 " us\n", scan_time);
 }
 
 /**
@@ -119,9 +261,9 @@ CargoPacket::CargoPacket()
  * that, in contrary to all other pools, does not memset to 0.
  */
 CargoPacket::CargoPacket(StationID source, TileIndex source_xy, uint16 count, SourceType source_type, SourceID source_id) :
-	feeder_share(0),
 	count(count),
 	days_in_transit(0),
+	feeder_share(0),
 	source_id(source_id),
 	source(source),
 	source_xy(source_xy),
@@ -146,9 +288,9 @@ CargoPacket::CargoPacket(StationID source, TileIndex source_xy, uint16 count, So
  * that, in contrary to all other pools, does not memset to 0.
  */
 CargoPacket::CargoPacket(uint16 count, byte days_in_transit, StationID source, TileIndex source_xy, TileIndex loaded_at_xy, Money feeder_share, SourceType source_type, SourceID source_id) :
-		feeder_share(feeder_share),
 		count(count),
 		days_in_transit(days_in_transit),
+		feeder_share(feeder_share),
 		source_id(source_id),
 		source(source),
 		source_xy(source_xy),
@@ -163,9 +305,7 @@ CargoPacket::~CargoPacket()
 {
 	if (CleaningPool()) return;
 
-	if (this->flags & CPF_HAS_DEFERRED_PAYMENT) {
-		IterateCargoPacketDeferredPayments(this->index, true, [](Money &payment, CompanyID cid, VehicleType type) { });
-	}
+	FreeCargoPacketDeferredPaymentBlocks(this->deferred_payments);
 }
 
 /**
@@ -181,17 +321,27 @@ CargoPacket *CargoPacket::Split(uint new_size)
 	CargoPacket *cp_new = new CargoPacket(new_size, this->days_in_transit, this->source, this->source_xy, this->loaded_at_xy, fs, this->source_type, this->source_id);
 	this->feeder_share -= fs;
 
-	if (this->flags & CPF_HAS_DEFERRED_PAYMENT) {
-		std::vector<std::pair<uint64, Money>> to_add;
-		IterateCargoPacketDeferredPayments(this->index, false, [&](Money &payment, CompanyID cid, VehicleType type) {
-			Money share = payment * new_size / static_cast<uint>(this->count);
-			payment -= share;
-			to_add.push_back({ CargoPacketDeferredPaymentKey(cp_new->index, cid, type), share });
-		});
-		for (auto &m : to_add) {
-			_cargo_packet_deferred_payments[m.first] = m.second;
+	/* Copy the chain of deferred payment blocks block by block, so the payments stay in order. */
+	uint32 prev = INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK;
+	for (uint32 src = this->deferred_payments; src != INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK; src = _cargo_packet_deferred_payment_blocks[src].next) {
+		uint32 block = AllocateCargoPacketDeferredPaymentBlock();
+		if (prev == INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK) {
+			cp_new->deferred_payments = block;
+		} else {
+			_cargo_packet_deferred_payment_blocks[prev].next = block;
+		}
+		prev = block;
+
+		CargoPacketDeferredPaymentBlock &from = _cargo_packet_deferred_payment_blocks[src];
+		CargoPacketDeferredPaymentBlock &to = _cargo_packet_deferred_payment_blocks[block];
+		for (uint i = 0; i < from.used; i++) {
+			Money share = from.payment[i] * new_size / static_cast<uint>(this->count);
+			from.payment[i] -= share;
+			to.payment[i] = share;
+			to.key[i] = from.key[i];
 		}
-		cp_new->flags |= CPF_HAS_DEFERRED_PAYMENT;
+		to.used = from.used;
+		_cargo_packet_deferred_payment_count += from.used;
 	}
 
 	this->count -= new_size;
@@ -207,18 +357,16 @@ void CargoPacket::Merge(CargoPacket *cp)
 	this->count += cp->count;
 	this->feeder_share += cp->feeder_share;
 
-	if (cp->flags & CPF_HAS_DEFERRED_PAYMENT) {
-		std::vector<std::pair<uint64, Money>> to_merge;
-		IterateCargoPacketDeferredPayments(cp->index, true, [&](Money &payment, CompanyID cid, VehicleType type) {
-			to_merge.push_back({ CargoPacketDeferredPaymentKey(this->index, cid, type), payment });
-		});
-		cp->flags &= ~CPF_HAS_DEFERRED_PAYMENT;
-
-		for (auto &m : to_merge) {
-			_cargo_packet_deferred_payments[m.first] += m.second;
+	/* Adding a payment may reallocate the blocks, so do not keep references across that. */
+	for (uint32 block = cp->deferred_payments; block != INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK; block = _cargo_packet_deferred_payment_blocks[block].next) {
+		for (uint i = 0; i < _cargo_packet_deferred_payment_blocks[block].used; i++) {
+			uint16 key = _cargo_packet_deferred_payment_blocks[block].key[i];
+			Money payment = _cargo_packet_deferred_payment_blocks[block].payment[i];
+			GetCargoPacketDeferredPayment(this->deferred_payments, key) += payment;
 		}
-		this->flags |= CPF_HAS_DEFERRED_PAYMENT;
 	}
+	FreeCargoPacketDeferredPaymentBlocks(cp->deferred_payments);
+	cp->deferred_payments = INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK;
 
 	delete cp;
 }
@@ -231,24 +379,21 @@ void CargoPacket::Reduce(uint count)
 {
 	assert(count < this->count);
 	this->feeder_share -= this->FeederShare(count);
-	if (this->flags & CPF_HAS_DEFERRED_PAYMENT) {
-		IterateCargoPacketDeferredPayments(this->index, false, [&](Money &payment, CompanyID cid, VehicleType type) {
-			payment -= payment * count / static_cast<uint>(this->count);
-		});
-	}
+	IterateCargoPacketDeferredPayments(this->deferred_payments, false, [&](Money &payment, CompanyID cid, VehicleType type) {
+		payment -= payment * count / static_cast<uint>(this->count);
+	});
 	this->count -= count;
 }
 
 void CargoPacket::RegisterDeferredCargoPayment(CompanyID cid, VehicleType type, Money payment)
 {
-	this->flags |= CPF_HAS_DEFERRED_PAYMENT;
-	_cargo_packet_deferred_payments[CargoPacketDeferredPaymentKey(this->index, cid, type)] += payment;
+	GetCargoPacketDeferredPayment(this->deferred_payments, CargoPacketDeferredPaymentSlotKey(cid, type)) += payment;
 }
 
 void CargoPacket::PayDeferredPayments()
 {
-	if (this->flags & CPF_HAS_DEFERRED_PAYMENT) {
-		IterateCargoPacketDeferredPayments(this->index, true, [&](Money &payment, CompanyID cid, VehicleType type) {
+	if (this->deferred_payments != INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK) {
+		IterateCargoPacketDeferredPayments(this->deferred_payments, true, [&](Money &payment, CompanyID cid, VehicleType type) {
 			Backup<CompanyByte> cur_company(_current_company, cid, FILE_LINE);
 
 			ExpensesType exp;
@@ -263,7 +408,6 @@ void CargoPacket::PayDeferredPayments()
 
 			cur_company.Restore();
 		});
-		this->flags &= ~CPF_HAS_DEFERRED_PAYMENT;
 	}
 }
 
@@ -399,6 +543,7 @@ template <class Tinst, class Tcont>
  */
 void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
 {
+	this->ApplyPendingAging();
 	assert(cp != nullptr);
 	assert(action == MTA_LOAD ||
 			(action == MTA_KEEP && this->action_counts[MTA_LOAD] == 0));
@@ -550,18 +695,52 @@ void VehicleCargoList::AddToMeta(const CargoPacket *cp, MoveToAction action)
 }
 
 /**
- * Ages the all cargo in this list.
+ * Updates the packets for the aging of the cargo since they were last updated.
+ * Aging a packet n times one by one, with its days in transit capped at 255,
+ * has the same result as adding n at once and capping the result.
+ * Has to be called before the packets are read or changed.
  */
-void VehicleCargoList::AgeCargo()
+void VehicleCargoList::ApplyPendingAging()
 {
-	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
-		CargoPacket *cp = *it;
-		/* If we're at the maximum, then we can't increase no more. */
-		if (cp->days_in_transit == 0xFF) continue;
+	if (this->pending_aging == 0) return;
+
+	for (CargoPacket *cp : this->packets) {
+		uint days_in_transit = min<uint>(cp->days_in_transit + this->pending_aging, 0xFF);
+		this->cargo_days_in_transit += (days_in_transit - cp->days_in_transit) * cp->count;
+		cp->days_in_transit = days_in_transit;
+	}
+	this->pending_aging = 0;
+}
+
+/**
+ * Applies the pending aging and checks that the result is the same as aging
+ * the packets by one step per call of AgeCargo.
+ * @return True if the packets and the cache match the step by step aging.
+ */
+bool VehicleCargoList::CheckPendingAging()
+{
+	std::vector<byte> expected;
+	uint expected_days_in_transit = this->cargo_days_in_transit;
+	for (const CargoPacket *cp : this->packets) {
+		byte days_in_transit = cp->days_in_transit;
+		for (uint i = 0; i < this->pending_aging; i++) {
+			/* If we're at the maximum, then we can't increase no more. */
+			if (days_in_transit == 0xFF) break;
+
+			days_in_transit++;
+			expected_days_in_transit += cp->count;
+		}
+		expected.push_back(days_in_transit);
+	}
+
+	this->ApplyPendingAging();
 
-		cp->days_in_transit++;
-		this->cargo_days_in_transit += cp->count;
+	bool ok = this->cargo_days_in_transit == expected_days_in_transit;
+	size_t i = 0;
+	for (const CargoPacket *cp : this->packets) {
+		if (cp->days_in_transit != expected[i++]) ok = false;
 	}
+	return ok;
 }
 
 /**
@@ -619,6 +798,7 @@ void VehicleCargoList::SetTransferLoadPlace(TileIndex xy)
  */
 bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationIDStack next_station, uint8 order_flags, const GoodsEntry *ge, CargoPayment *payment)
 {
+	this->ApplyPendingAging();
 	this->AssertCountConsistency();
 	assert(this->action_counts[MTA_LOAD] == 0);
 	this->action_counts[MTA_TRANSFER] = this->action_counts[MTA_DELIVER] = this->action_counts[MTA_KEEP] = 0;
@@ -714,6 +894,7 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 /** Invalidates the cached data and rebuild it. */
 void VehicleCargoList::InvalidateCache()
 {
+	this->ApplyPendingAging();
 	this->feeder_share = 0;
 	this->Parent::InvalidateCache();
 }
@@ -751,6 +932,7 @@ uint VehicleCargoList::Reassign(uint max_move, TileOrStationID)
 template<>
 uint VehicleCargoList::Reassign<VehicleCargoList::MTA_DELIVER, VehicleCargoList::MTA_TRANSFER>(uint max_move, TileOrStationID next_station)
 {
+	this->ApplyPendingAging();
 	max_move = min(this->action_counts[MTA_DELIVER], max_move);
 
 	uint sum = 0;
@@ -784,6 +966,7 @@ uint VehicleCargoList::Reassign<VehicleCargoList::MTA_DELIVER, VehicleCargoList:
  */
 uint VehicleCargoList::Return(uint max_move, StationCargoList *dest, StationID next)
 {
+	this->ApplyPendingAging();
 	max_move = min(this->action_counts[MTA_LOAD], max_move);
 	this->PopCargo(CargoReturn(this, dest, max_move, next));
 	return max_move;
@@ -797,6 +980,8 @@ uint VehicleCargoList::Return(uint max_move, StationCargoList *dest, StationID n
  */
 uint VehicleCargoList::Shift(uint max_move, VehicleCargoList *dest)
 {
+	this->ApplyPendingAging();
+	dest->ApplyPendingAging();
 	max_move = min(this->count, max_move);
 	this->PopCargo(CargoShift(this, dest, max_move));
 	return max_move;
@@ -812,6 +997,7 @@ uint VehicleCargoList::Shift(uint max_move, VehicleCargoList *dest)
  */
 uint VehicleCargoList::Unload(uint max_move, StationCargoList *dest, CargoPayment *payment)
 {
+	this->ApplyPendingAging();
 	uint moved = 0;
 	if (this->action_counts[MTA_TRANSFER] > 0) {
 		uint move = min(this->action_counts[MTA_TRANSFER], max_move);
@@ -834,6 +1020,7 @@ uint VehicleCargoList::Unload(uint max_move, StationCargoList *dest, CargoPaymen
  */
 uint VehicleCargoList::Truncate(uint max_move)
 {
+	this->ApplyPendingAging();
 	max_move = min(this->count, max_move);
 	if (max_move > this->ActionCount(MTA_KEEP)) this->KeepAll();
 	this->PopCargo(CargoRemoval<VehicleCargoList>(this, max_move));
@@ -850,6 +1037,8 @@ uint VehicleCargoList::Truncate(uint max_move)
  */
 uint VehicleCargoList::Reroute(uint max_move, VehicleCargoList *dest, StationID avoid, StationID avoid2, const GoodsEntry *ge)
 {
+	this->ApplyPendingAging();
+	dest->ApplyPendingAging();
 	max_move = min(this->action_counts[MTA_TRANSFER], max_move);
 	this->ShiftCargoWithFrontInsert(VehicleCargoReroute(this, dest, max_move, avoid, avoid2, ge));
 	return max_move;
@@ -1004,6 +1193,7 @@ uint StationCargoList::Truncate(uint max_move, StationCargoAmountMap *cargo_per_
  */
 uint StationCargoList::Reserve(uint max_move, VehicleCargoList *dest, TileIndex load_place, StationIDStack next_station)
 {
+	dest->ApplyPendingAging();
 	return this->ShiftCargo(CargoReservation(this, dest, max_move, load_place), next_station, true);
 }
 
@@ -1021,6 +1211,7 @@ uint StationCargoList::Reserve(uint max_move, VehicleCargoList *dest, TileIndex
  */
 uint StationCargoList::Load(uint max_move, VehicleCargoList *dest, TileIndex load_place, StationIDStack next_station)
 {
+	dest->ApplyPendingAging();
 	uint move = min(dest->ActionCount(VehicleCargoList::MTA_LOAD), max_move);
 	if (move > 0) {
 		this->reserved_count -= move;
@@ -20,7 +20,9 @@
 #include "vehicle_type.h"
 #include "company_type.h"
 #include "core/multimap.hpp"
+#include "core/bitmath_func.hpp"
 #include <deque>
+#include <vector>
 
 /** Unique identifier for a single cargo packet. */
 typedef uint32 CargoPacketID;
@@ -42,15 +44,54 @@ typedef uint32 TileOrStationID;
 void ClearCargoPacketDeferredPayments();
 void ChangeOwnershipOfCargoPacketDeferredPayments(Owner old_owner, Owner new_owner);
 
+/**
+ * Block of deferred payments of a cargo packet, for one company and vehicle type each.
+ * The blocks of a packet form a chain, in which the payments are sorted by company and
+ * vehicle type. All blocks but the last one of a chain are full.
+ */
+struct CargoPacketDeferredPaymentBlock {
+	static const uint SLOTS = 3;  ///< Number of payments in one block.
+
+	Money payment[SLOTS];         ///< Payments of the used slots.
+	uint16 key[SLOTS];            ///< Company (bits 2..9) and vehicle type (bits 0..1) of the used slots.
+	uint8 used;                   ///< Number of used slots.
+	uint32 next;                  ///< Next block of the same packet, or #INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK.
+};
+
+/** Index of no deferred payment block, ends a chain of blocks. */
+static const uint32 INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK = UINT32_MAX;
+
+/** Storage of all deferred payment blocks, unused blocks are chained in a free list. */
+extern std::vector<CargoPacketDeferredPaymentBlock> _cargo_packet_deferred_payment_blocks;
+/** Number of deferred payments in all cargo packets. */
+extern uint _cargo_packet_deferred_payment_count;
+
+/**
+ * Call a functor for all payments of a chain of deferred payment blocks.
+ * @param block First block of the chain.
+ * @param functor Functor taking (Money &payment, CompanyID cid, VehicleType type), it must not add payments.
+ */
+template <typename F>
+inline void IterateCargoPacketDeferredPaymentBlocks(uint32 block, F functor)
+{
+	for (; block != INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK; block = _cargo_packet_deferred_payment_blocks[block].next) {
+		CargoPacketDeferredPaymentBlock &b = _cargo_packet_deferred_payment_blocks[block];
+		for (uint i = 0; i < b.used; i++) {
+			functor(b.payment[i], (CompanyID) GB(b.key[i], 2, 8), (VehicleType) GB(b.key[i], 0, 2));
+		}
+	}
+}
+
 /**
  * Container for cargo from the same location and time.
  */
 struct CargoPacket : CargoPacketPool::PoolItem<&_cargopacket_pool> {
 private:
-	Money feeder_share;         ///< Value of feeder pickup to be paid for on delivery of cargo.
+	/* The members are ordered so that they fill the space after the pool index without padding. */
 	uint16 count;               ///< The amount of cargo in this packet.
 	byte days_in_transit;       ///< Amount of days this packet has been in transit.
 	SourceTypeByte source_type; ///< Type of \c source_id.
+	Money feeder_share;         ///< Value of feeder pickup to be paid for on delivery of cargo.
 	SourceID source_id;         ///< Index of source, INVALID_SOURCE if unknown/invalid.
 	StationID source;           ///< The station where the cargo came from first.
 	TileIndex source_xy;        ///< The origin of the cargo (first station in feeder chain).
@@ -58,12 +99,7 @@ private:
 		TileOrStationID loaded_at_xy; ///< Location where this cargo has been loaded into the vehicle.
 		TileOrStationID next_station; ///< Station where the cargo wants to go next.
 	};
-	uint flags = 0;             ///< NOSAVE: temporary flags
-
-	/** Cargo packet flag bits in CargoPacket::flags. */
-	enum CargoPacketFlags {
-		CPF_HAS_DEFERRED_PAYMENT = 0x01, ///< Cargo packet has 1 or more deferred payment(s)
-	};
+	uint32 deferred_payments = INVALID_CARGO_PACKET_DEFERRED_PAYMENT_BLOCK; ///< NOSAVE: first block of the deferred payments of this packet
 
 	/** The CargoList caches, thus needs to know about it. */
 	template <class Tinst, class Tcont> friend class CargoList;
@@ -71,7 +107,7 @@ private:
 	friend class StationCargoList;
 	/** We want this to be saved, right? */
 	friend const struct SaveLoad *GetCargoPacketDesc();
-	friend void Load_CPDP();
+	friend void ChangeOwnershipOfCargoPacketDeferredPayments(Owner old_owner, Owner new_owner);
 public:
 	/** Maximum number of items in a single cargo packet. */
 	static const uint16 MAX_COUNT = UINT16_MAX;
@@ -136,6 +172,18 @@ public:
 	void RegisterDeferredCargoPayment(CompanyID cid, VehicleType type, Money payment);
 	void PayDeferredPayments();
 
+	/**
+	 * Call a functor for all deferred payments of this packet, ordered by company and vehicle type.
+	 * @param functor Functor taking (Money payment, CompanyID cid, VehicleType type).
+	 */
+	template <typename F>
+	void IterateDeferredPayments(F functor) const
+	{
+		IterateCargoPacketDeferredPaymentBlocks(this->deferred_payments, [&](Money &payment, CompanyID cid, VehicleType type) {
+			functor(payment, cid, type);
+		});
+	}
+
 	/**
 	 * Gets the number of days this cargo has been in transit.
 	 * This number isn't really in days, but in 2.5 days (CARGO_AGING_TICKS = 185 ticks) and
@@ -299,6 +347,7 @@ protected:
 
 	Money feeder_share;                     ///< Cache for the feeder share.
 	uint action_counts[NUM_MOVE_TO_ACTION]; ///< Counts of cargo to be transfered, delivered, kept and loaded.
+	byte pending_aging = 0;                 ///< NOSAVE: Number of times the cargo has been aged without updating the packets, capped at 255 like CargoPacket::days_in_transit.
 
 	template<class Taction>
 	void ShiftCargo(Taction action);
@@ -439,9 +488,29 @@ public:
 		return this->action_counts[MTA_KEEP] + this->action_counts[MTA_LOAD];
 	}
 
+	/**
+	 * Returns average number of days in transit for a cargo entity.
+	 * @return The before mentioned number.
+	 */
+	inline uint DaysInTransit() const
+	{
+		if (this->pending_aging != 0) const_cast<VehicleCargoList *>(this)->ApplyPendingAging();
+		return this->Parent::DaysInTransit();
+	}
+
 	void Append(CargoPacket *cp, MoveToAction action = MTA_KEEP);
 
-	void AgeCargo();
+	/**
+	 * Ages the all cargo in this list. The packets are only updated when
+	 * they are needed, so aging is cheap for vehicles that are travelling.
+	 */
+	inline void AgeCargo()
+	{
+		if (this->pending_aging != 0xFF && !this->packets.empty()) this->pending_aging++;
+	}
+
+	void ApplyPendingAging();
+	bool CheckPendingAging();
 
 	void InvalidateCache();
 
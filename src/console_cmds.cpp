@@ -34,16 +34,21 @@
 #include "gamelog.h"
 #include "ai/ai.hpp"
 #include "ai/ai_config.hpp"
+#include "ai/ai_info.hpp"
+#include "ai/ai_instance.hpp"
 #include "newgrf.h"
 #include "console_func.h"
 #include "engine_base.h"
 #include "game/game.hpp"
+#include "game/game_info.hpp"
+#include "game/game_instance.hpp"
 #include "table/strings.h"
 #include "aircraft.h"
 #include "airport.h"
 #include "station_base.h"
 #include "economy_func.h"
 #include "string_func_extra.h"
+#include "gfx_layout.h"
 
 #include "safeguards.h"
 
@@ -2039,6 +2044,44 @@ DEF_CONSOLE_CMD(ConMapStats)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConDumpDirtyRedrawStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Dump statistics about redrawing dirty screen areas. Usage: 'dump_dirty_redraw_stats [reset]'");
+		return true;
+	}
+
+	extern void DumpDirtyRedrawStats(char *b, const char *last);
+	extern void ResetDirtyRedrawStats();
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		ResetDirtyRedrawStats();
+		return true;
+	}
+
+	char buffer[32768];
+	DumpDirtyRedrawStats(buffer, lastof(buffer));
+	PrintLineByLine(buffer);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConDumpLineCacheStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Dump statistics about the text layout line cache. Usage: 'dump_linecache_stats [reset]'");
+		return true;
+	}
+
+	if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+		Layouter::ResetLineCacheStats();
+		return true;
+	}
+
+	char buffer[32768];
+	Layouter::DumpLineCacheStats(buffer, lastof(buffer));
+	PrintLineByLine(buffer);
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConDumpGameEvents)
 {
 	if (argc == 0) {
@@ -2054,6 +2097,41 @@ DEF_CONSOLE_CMD(ConDumpGameEvents)
 	return true;
 }
 
+/**
+ * Print the profiling counters of a script to the console.
+ * @param name Name of the script.
+ * @param instance The script.
+ */
+static void PrintScriptProfile(const char *name, const ScriptInstance *instance)
+{
+	SquirrelProfile profile = instance->GetProfile();
+	IConsolePrintF(CC_DEFAULT, "%s: ops: " OTTD_PRINTF64U ", allocations: " OTTD_PRINTF64U ", pool: " OTTD_PRINTF64U " bytes, GC: %u runs, " OTTD_PRINTF64U " us, max pause: " OTTD_PRINTF64U " us, freed: " OTTD_PRINTF64U "%s",
+			name, profile.ops, profile.allocations, profile.pool_bytes, profile.gc_runs, profile.gc_time, profile.gc_max_pause, profile.gc_collected, instance->IsDead() ? " (dead)" : "");
+}
+
+DEF_CONSOLE_CMD(ConDumpScriptProfile)
+{
+	if (argc == 0) {
+		IConsoleHelp("Dump the profiling counters (operations, allocations, garbage collection) of all running AIs and the game script.");
+		return true;
+	}
+
+	const Company *c;
+	FOR_ALL_COMPANIES(c) {
+		if (!c->is_ai || c->ai_instance == nullptr) continue;
+		char name[128];
+		seprintf(name, lastof(name), "AI %u (%s)", c->index + 1, c->ai_info->GetName());
+		PrintScriptProfile(name, c->ai_instance);
+	}
+
+	if (Game::GetInstance() != nullptr) {
+		char name[128];
+		seprintf(name, lastof(name), "Game script (%s)", Game::GetInfo()->GetName());
+		PrintScriptProfile(name, Game::GetInstance());
+	}
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConDumpLoadDebugLog)
 {
 	if (argc == 0) {
@@ -2341,6 +2419,9 @@ void IConsoleStdLibRegister()
 	IConsoleCmdRegister("dump_veh_stats", ConVehicleStats, nullptr, true);
 	IConsoleCmdRegister("dump_map_stats", ConMapStats, nullptr, true);
 	IConsoleCmdRegister("dump_game_events", ConDumpGameEvents, nullptr, true);
+	IConsoleCmdRegister("dump_script_profile", ConDumpScriptProfile, nullptr, true);
+	IConsoleCmdRegister("dump_dirty_redraw_stats", ConDumpDirtyRedrawStats, nullptr, true);
+	IConsoleCmdRegister("dump_linecache_stats", ConDumpLineCacheStats, nullptr, true);
 	IConsoleCmdRegister("dump_load_debug_log", ConDumpLoadDebugLog, nullptr, true);
 	IConsoleCmdRegister("check_caches", ConCheckCaches, nullptr, true);
 
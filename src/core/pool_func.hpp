@@ -40,7 +40,9 @@ DEFINE_POOL_METHOD(inline)::Pool(const char *name) :
 #endif /* OTTD_ASSERT */
 		cleaning(false),
 		data(nullptr),
-		alloc_cache(nullptr)
+		alloc_cache(nullptr),
+		alloc_chunks(nullptr),
+		alloc_chunk_free(0)
 { }
 
 /**
@@ -115,6 +117,20 @@ DEFINE_POOL_METHOD(inline void *)::AllocateItem(size_t size, size_t index)
 			 * we are actually memsetting a (not-yet-constructed) object */
 			memset((void *)item, 0, sizeof(Titem));
 		}
+	} else if (Tcache) {
+		/* Carve the item from a chunk, so items that are allocated
+		 * one after another also lie next to each other in memory. */
+		assert(sizeof(Titem) == size);
+		assert_compile(sizeof(AllocChunk) <= ALLOC_CHUNK_HEADER_SIZE);
+		if (this->alloc_chunk_free == 0) {
+			AllocChunk *chunk = (AllocChunk *)MallocT<byte>(ALLOC_CHUNK_HEADER_SIZE + Tgrowth_step * sizeof(Titem));
+			chunk->next = this->alloc_chunks;
+			this->alloc_chunks = chunk;
+			this->alloc_chunk_free = Tgrowth_step;
+		}
+		item = (Titem *)((byte *)this->alloc_chunks + ALLOC_CHUNK_HEADER_SIZE + (Tgrowth_step - this->alloc_chunk_free) * sizeof(Titem));
+		this->alloc_chunk_free--;
+		if (Tzero) memset((void *)item, 0, sizeof(Titem));
 	} else if (Tzero) {
 		item = (Titem *)CallocT<byte>(size);
 	} else {
@@ -209,11 +225,14 @@ DEFINE_POOL_METHOD(void)::CleanPool()
 	this->cleaning = false;
 
 	if (Tcache) {
-		while (this->alloc_cache != nullptr) {
-			AllocCache *ac = this->alloc_cache;
-			this->alloc_cache = ac->next;
-			free(ac);
+		/* The cached items are part of the chunks. */
+		this->alloc_cache = nullptr;
+		while (this->alloc_chunks != nullptr) {
+			AllocChunk *chunk = this->alloc_chunks;
+			this->alloc_chunks = chunk->next;
+			free(chunk);
 		}
+		this->alloc_chunk_free = 0;
 	}
 }
 
@@ -75,7 +75,8 @@ private:
  * @tparam Tgrowth_step Size of growths; if the pool is full increase the size by this amount
  * @tparam Tmax_size    Maximum size of the pool
  * @tparam Tpool_type   Type of this pool
- * @tparam Tcache       Whether to perform 'alloc' caching, i.e. don't actually free/malloc just reuse the memory
+ * @tparam Tcache       Whether to perform 'alloc' caching, i.e. don't actually free/malloc just reuse the memory;
+ *                      the items are then allocated in chunks of \a Tgrowth_step items
  * @tparam Tzero        Whether to zero the memory
  * @warning when Tcache is enabled *all* instances of this pool's item must be of the same size.
  */
@@ -310,6 +311,21 @@ private:
 	/** Cache of freed pointers */
 	AllocCache *alloc_cache;
 
+	/**
+	 * Header of a chunk of memory the items of a pool with
+	 * 'alloc' caching are allocated from.
+	 */
+	struct AllocChunk {
+		/** The chunk that was allocated before this one */
+		AllocChunk *next;
+	};
+
+	/** Offset of the first item in a chunk; keeps the items aligned like malloc does */
+	static const size_t ALLOC_CHUNK_HEADER_SIZE = 16;
+
+	AllocChunk *alloc_chunks; ///< All chunks, the one items are currently allocated from first
+	size_t alloc_chunk_free;  ///< Number of items not yet allocated from the first chunk
+
 	void *AllocateItem(size_t size, size_t index);
 	void ResizeFor(size_t index);
 	size_t FindFirstFree();
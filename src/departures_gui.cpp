@@ -95,6 +95,7 @@ protected:
 	bool cargo_buttons_disabled;///< Show pax/freight buttons disabled
 	uint min_width;            ///< The minimum width of this window.
 	Scrollbar *vscroll;
+	mutable FormattedStringCache time_strings; ///< Formatted times of the departures.
 
 	virtual uint GetMinWidth() const;
 	static void RecomputeDateWidth();
@@ -679,8 +680,9 @@ void DeparturesWindow<Twaypoint>::DrawDeparturesListItems(const Rect &r) const
 		/* Time */
 		SetDParam(0, d->scheduled_date);
 		SetDParam(1, d->scheduled_date - (d->scheduled_waiting_time > 0 ? d->scheduled_waiting_time : d->order->GetWaitTime()));
-		ltr ? DrawString(              text_left, text_left + time_width, y + 1, time_str)
-			: DrawString(text_right - time_width,             text_right, y + 1, time_str);
+		const char *time = this->time_strings.GetString(time_str, 2);
+		ltr ? DrawString(              text_left, text_left + time_width, y + 1, time)
+			: DrawString(text_right - time_width,             text_right, y + 1, time);
 
 		/* Vehicle type icon, with thanks to sph */
 		if (_settings_client.gui.departure_show_vehicle_type) {
@@ -809,7 +811,7 @@ void DeparturesWindow<Twaypoint>::DrawDeparturesListItems(const Rect &r) const
 					} else {
 						/* The vehicle is expected to be late and is not yet due to arrive. */
 						SetDParam(0, d->scheduled_date + d->lateness);
-						DrawString(status_left, status_right, y + 1, STR_DEPARTURES_EXPECTED);
+						DrawString(status_left, status_right, y + 1, this->time_strings.GetString(STR_DEPARTURES_EXPECTED, 1));
 					}
 				}
 			}
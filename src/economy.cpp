@@ -1918,6 +1918,7 @@ static void LoadUnloadVehicle(Vehicle *front)
 					 * first unload to prevent the cargo from quickly decaying after the initial drop. */
 					ge->time_since_pickup = 0;
 					SetBit(ge->status, GoodsEntry::GES_RATING);
+					SetBit(st->rating_cargoes, v->cargo_type);
 				}
 			}
 
@@ -32,6 +32,8 @@ void StartupIndustryDailyChanges(bool init_counter);
 
 Money GetTransportedGoodsIncome(uint num_pieces, uint dist, byte transit_days, CargoID cargo_type);
 uint MoveGoodsToStation(CargoID type, uint amount, SourceType source_type, SourceID source_id, const StationList *all_stations);
+void SelectStationsForGoods(CargoID type, const StationList *all_stations, Station **st1, Station **st2);
+uint MoveGoodsToSelectedStations(CargoID type, uint amount, SourceType source_type, SourceID source_id, Station *st1, Station *st2);
 
 void PrepareUnload(Vehicle *front_v);
 void LoadUnloadStation(Station *st);
@@ -201,6 +201,7 @@ void GameInstance::RegisterAPI()
 	SQGSTileList_Register(this->engine);
 	SQGSTileList_IndustryAccepting_Register(this->engine);
 	SQGSTileList_IndustryProducing_Register(this->engine);
+	SQGSTileList_Property_Register(this->engine);
 	SQGSTileList_StationType_Register(this->engine);
 	SQGSTown_Register(this->engine);
 	SQGSTownEffectList_Register(this->engine);
@@ -20,9 +20,13 @@
 #include "network/network.h"
 #include "network/network_func.h"
 #include "window_func.h"
+#include "viewport_func.h"
 #include "newgrf_debug.h"
 #include "thread.h"
 
+#include <chrono>
+#include <vector>
+
 #include "table/palettes.h"
 #include "table/string_colours.h"
 #include "table/sprites.h"
@@ -77,6 +81,28 @@ static const uint DIRTY_BLOCK_WIDTH    = 64;
 
 static uint _dirty_bytes_per_line = 0;
 static byte *_dirty_blocks = nullptr;
+
+static const uint DIRTY_RECT_MAX_COUNT  = 256;  ///< Maximum number of rectangles in #_dirty_rects, further rectangles are merged into existing ones.
+static const int64 DIRTY_RECT_MERGE_COST = 4096; ///< Cost of an additional #RedrawScreenRect call, in pixels of overdraw.
+static const uint DIRTY_RECT_MERGE_PASSES = 3;   ///< Maximum number of passes over the dirty rectangles to merge them.
+
+/**
+ * Dirty areas when they are tracked as a list of rectangles instead of #_dirty_blocks.
+ * The right and bottom edges of these rectangles are exclusive.
+ * @see GUISettings::dirty_rect_tracking
+ */
+static std::vector<Rect> _dirty_rects;
+
+/** Statistics about the redrawing of dirty areas. */
+struct DirtyRedrawStats {
+	uint64 frames;       ///< Number of calls to #DrawDirtyBlocks which redrew something.
+	uint64 redraws;      ///< Number of calls to #RedrawScreenRect.
+	uint64 pixels;       ///< Number of redrawn pixels.
+	uint64 time_us;      ///< Time spent redrawing, in microseconds.
+};
+
+/** Statistics about the redrawing of dirty areas, indexed by whether dirty areas were tracked as rectangles. */
+static DirtyRedrawStats _dirty_redraw_stats[2];
 extern uint _dirty_block_colour;
 
 void GfxScroll(int left, int top, int width, int height, int xo, int yo)
@@ -1195,6 +1221,8 @@ void ScreenSizeChanged()
 	extern uint32 *_vp_map_line;
 	_vp_map_line = ReallocT<uint32>(_vp_map_line, _screen.width);
 
+	_dirty_rects.clear();
+
 	/* check the dirty rect */
 	if (_invalid_rect.right >= _screen.width) _invalid_rect.right = _screen.width;
 	if (_invalid_rect.bottom >= _screen.height) _invalid_rect.bottom = _screen.height;
@@ -1296,6 +1324,9 @@ void RedrawScreenRect(int left, int top, int right, int bottom)
 	VideoDriver::GetInstance()->MakeDirty(left, top, right - left, bottom - top);
 }
 
+static void DrawDirtyBlockBitmap(DirtyRedrawStats &stats);
+static void DrawDirtyRects(DirtyRedrawStats &stats);
+
 /**
  * Repaints the rectangle blocks which are marked as 'dirty'.
  *
@@ -1303,12 +1334,6 @@ void RedrawScreenRect(int left, int top, int right, int bottom)
  */
 void DrawDirtyBlocks()
 {
-	byte *b = _dirty_blocks;
-	const int w = Align(_screen.width,  DIRTY_BLOCK_WIDTH);
-	const int h = Align(_screen.height, DIRTY_BLOCK_HEIGHT);
-	int x;
-	int y;
-
 	if (HasModalProgress()) {
 		/* We are generating the world, so release our rights to the map and
 		 * painting while we are waiting a bit. */
@@ -1332,6 +1357,59 @@ void DrawDirtyBlocks()
 		if (_switch_mode != SM_NONE && !HasModalProgress()) return;
 	}
 
+	const bool use_rects = _settings_client.gui.dirty_rect_tracking;
+	DirtyRedrawStats &stats = _dirty_redraw_stats[use_rects ? 1 : 0];
+	const uint64 redraws_before = stats.redraws;
+	const auto start_time = std::chrono::steady_clock::now();
+
+	if (use_rects) {
+		DrawDirtyRects(stats);
+		/* Blocks may have been marked while rectangle tracking was off, do not leave them pending. */
+		memset(_dirty_blocks, 0, _dirty_bytes_per_line * CeilDiv(_screen.height, DIRTY_BLOCK_HEIGHT));
+	} else {
+		DrawDirtyBlockBitmap(stats);
+		_dirty_rects.clear();
+	}
+
+	if (stats.redraws != redraws_before) {
+		stats.frames++;
+		stats.time_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+	}
+
+	++_dirty_block_colour;
+	_invalid_rect.left = Align(_screen.width,  DIRTY_BLOCK_WIDTH);
+	_invalid_rect.top = Align(_screen.height, DIRTY_BLOCK_HEIGHT);
+	_invalid_rect.right = 0;
+	_invalid_rect.bottom = 0;
+}
+
+/**
+ * Redraw a dirty area of the screen and account for it in the statistics.
+ * @param left Left edge.
+ * @param top Top edge.
+ * @param right Right edge (exclusive).
+ * @param bottom Bottom edge (exclusive).
+ * @param stats Statistics to update.
+ */
+static void RedrawDirtyScreenRect(int left, int top, int right, int bottom, DirtyRedrawStats &stats)
+{
+	RedrawScreenRect(left, top, right, bottom);
+	stats.redraws++;
+	stats.pixels += (uint64)(right - left) * (bottom - top);
+}
+
+/**
+ * Repaints the blocks of #_dirty_blocks which are marked as 'dirty', coalescing neighbouring blocks.
+ * @param stats Statistics to update.
+ */
+static void DrawDirtyBlockBitmap(DirtyRedrawStats &stats)
+{
+	byte *b = _dirty_blocks;
+	const int w = Align(_screen.width,  DIRTY_BLOCK_WIDTH);
+	const int h = Align(_screen.height, DIRTY_BLOCK_HEIGHT);
+	int x;
+	int y;
+
 	y = 0;
 	do {
 		x = 0;
@@ -1387,18 +1465,128 @@ void DrawDirtyBlocks()
 				if (bottom > _invalid_rect.bottom) bottom = _invalid_rect.bottom;
 
 				if (left < right && top < bottom) {
-					RedrawScreenRect(left, top, right, bottom);
+					RedrawDirtyScreenRect(left, top, right, bottom, stats);
 				}
 
 			}
 		} while (b++, (x += DIRTY_BLOCK_WIDTH) != w);
 	} while (b += -(int)(w / DIRTY_BLOCK_WIDTH) + _dirty_bytes_per_line, (y += DIRTY_BLOCK_HEIGHT) != h);
+}
 
-	++_dirty_block_colour;
-	_invalid_rect.left = w;
-	_invalid_rect.top = h;
-	_invalid_rect.right = 0;
-	_invalid_rect.bottom = 0;
+static inline int64 RectArea(const Rect &r)
+{
+	return (int64)(r.right - r.left) * (r.bottom - r.top);
+}
+
+static inline Rect RectBoundingBox(const Rect &a, const Rect &b)
+{
+	return { min(a.left, b.left), min(a.top, b.top), max(a.right, b.right), max(a.bottom, b.bottom) };
+}
+
+/**
+ * Get the number of pixels which would be drawn in excess when two dirty rectangles are replaced by their bounding box.
+ * @param a First rectangle.
+ * @param b Second rectangle.
+ * @return Excess pixels, negative if the rectangles overlap by more than the bounding box adds.
+ */
+static int64 GetDirtyRectMergeOverdraw(const Rect &a, const Rect &b)
+{
+	int64 overlap = 0;
+	const int overlap_w = min(a.right, b.right) - max(a.left, b.left);
+	const int overlap_h = min(a.bottom, b.bottom) - max(a.top, b.top);
+	if (overlap_w > 0 && overlap_h > 0) overlap = (int64)overlap_w * overlap_h;
+	return RectArea(RectBoundingBox(a, b)) - RectArea(a) - RectArea(b) + overlap;
+}
+
+/**
+ * Add a dirty rectangle to #_dirty_rects.
+ * If the list is full, the rectangle is merged into the existing rectangle which causes the least overdraw.
+ * @param r Rectangle to add, already clipped to the screen.
+ */
+static void AddDirtyRect(const Rect &r)
+{
+	int64 best_overdraw = INT64_MAX;
+	Rect *best = nullptr;
+	for (Rect &existing : _dirty_rects) {
+		if (existing.left <= r.left && existing.top <= r.top && existing.right >= r.right && existing.bottom >= r.bottom) return;
+		if (_dirty_rects.size() >= DIRTY_RECT_MAX_COUNT) {
+			int64 overdraw = GetDirtyRectMergeOverdraw(existing, r);
+			if (overdraw < best_overdraw) {
+				best_overdraw = overdraw;
+				best = &existing;
+			}
+		}
+	}
+	if (best != nullptr) {
+		*best = RectBoundingBox(*best, r);
+	} else {
+		_dirty_rects.push_back(r);
+	}
+}
+
+/**
+ * Repaints the rectangles of #_dirty_rects.
+ * Pairs of rectangles are merged into their bounding box as long as the extra pixels drawn cost less than an additional redraw call.
+ * Rectangles marked dirty while painting are kept for the next call.
+ * @param stats Statistics to update.
+ */
+static void DrawDirtyRects(DirtyRedrawStats &stats)
+{
+	/* Painting may mark further areas dirty, take the current rectangles out of the way of that. */
+	static std::vector<Rect> rects;
+	rects.clear();
+	rects.swap(_dirty_rects);
+
+	/* Each pass is quadratic in the number of rectangles, so only a few passes are made. */
+	bool merged = true;
+	for (uint pass = 0; merged && pass < DIRTY_RECT_MERGE_PASSES; pass++) {
+		merged = false;
+		for (size_t i = 0; i < rects.size(); i++) {
+			for (size_t j = i + 1; j < rects.size();) {
+				if (GetDirtyRectMergeOverdraw(rects[i], rects[j]) <= DIRTY_RECT_MERGE_COST) {
+					rects[i] = RectBoundingBox(rects[i], rects[j]);
+					rects[j] = rects.back();
+					rects.pop_back();
+					merged = true;
+				} else {
+					j++;
+				}
+			}
+		}
+	}
+
+	for (const Rect &r : rects) {
+		const int right = min(r.right, _screen.width);
+		const int bottom = min(r.bottom, _screen.height);
+		if (r.left < right && r.top < bottom) RedrawDirtyScreenRect(r.left, r.top, right, bottom, stats);
+	}
+}
+
+/**
+ * Dump statistics about the redrawing of dirty areas, for both ways of tracking them.
+ * @param b Buffer to write to.
+ * @param last Last valid byte of the buffer.
+ */
+void DumpDirtyRedrawStats(char *b, const char *last)
+{
+	for (uint i = 0; i < lengthof(_dirty_redraw_stats); i++) {
+		const DirtyRedrawStats &stats = _dirty_redraw_stats[i];
+		b += seprintf(b, last, "%s:\n", i == 0 ? "Dirty blocks" : "Dirty rectangles");
+		b += seprintf(b, last, "  Frames: " OTTD_PRINTF64U ", redraw calls: " OTTD_PRINTF64U ", pixels: " OTTD_PRINTF64U ", time: " OTTD_PRINTF64U " us\n",
+				stats.frames, stats.redraws, stats.pixels, stats.time_us);
+		if (stats.frames > 0) {
+			b += seprintf(b, last, "  Per frame: redraw calls: " OTTD_PRINTF64U ", pixels: " OTTD_PRINTF64U ", time: " OTTD_PRINTF64U " us\n",
+					stats.redraws / stats.frames, stats.pixels / stats.frames, stats.time_us / stats.frames);
+		}
+	}
+}
+
+/**
+ * Reset the statistics about the redrawing of dirty areas.
+ */
+void ResetDirtyRedrawStats()
+{
+	memset(_dirty_redraw_stats, 0, sizeof(_dirty_redraw_stats));
 }
 
 /**
@@ -1434,6 +1622,11 @@ void SetDirtyBlocks(int left, int top, int right, int bottom)
 	if (right  > _invalid_rect.right ) _invalid_rect.right  = right;
 	if (bottom > _invalid_rect.bottom) _invalid_rect.bottom = bottom;
 
+	if (_settings_client.gui.dirty_rect_tracking) {
+		AddDirtyRect({ left, top, right, bottom });
+		return;
+	}
+
 	left /= DIRTY_BLOCK_WIDTH;
 	top  /= DIRTY_BLOCK_HEIGHT;
 
@@ -1461,6 +1654,8 @@ void SetDirtyBlocks(int left, int top, int right, int bottom)
  */
 void MarkWholeScreenDirty()
 {
+	ClearTileSpriteCache();
+	InvalidateFormattedStringCaches();
 	SetDirtyBlocks(0, 0, _screen.width, _screen.height);
 }
 
@@ -873,9 +873,36 @@ void Layouter::ResetFontCache(FontSize size)
 #endif
 }
 
+/** Maximum number of lines kept in the linecache after it is reduced. */
+static const size_t LINE_CACHE_MAX_ITEMS = 4096;
+
+/** Statistics of the linecache. */
+static struct LineCacheStats {
+	uint64 hits;      ///< Number of lookups that found a cached layout.
+	uint64 misses;    ///< Number of lookups that had to add a new item.
+	uint64 evictions; ///< Number of items evicted because the cache was full.
+	uint64 resets;    ///< Number of times the whole cache was cleared.
+} _line_cache_stats;
+
+size_t Layouter::LineCacheKeyHash::operator()(const LineCacheKey &key) const
+{
+	/* FNV-1a over the string, mixed with the font state. */
+	size_t hash = (size_t)2166136261U;
+	for (size_t i = 0; i < key.len; i++) {
+		hash = (hash ^ (byte)key.str[i]) * (size_t)16777619U;
+	}
+	hash = (hash ^ key.state_before->fontsize) * (size_t)16777619U;
+	hash = (hash ^ key.state_before->cur_colour) * (size_t)16777619U;
+	hash = (hash ^ key.state_before->colour_stack.size()) * (size_t)16777619U;
+	if (!key.state_before->colour_stack.empty()) hash = (hash ^ key.state_before->colour_stack.top()) * (size_t)16777619U;
+	return hash;
+}
+
 /**
  * Get reference to cache item.
  * If the item does not exist yet, it is default constructed.
+ * The item is marked as most recently used. Items are only evicted by
+ * #ReduceLineCache, so the reference stays valid until then.
  * @param str Source string of the line (including colour and font size codes).
  * @param len Length of \a str in bytes (no termination).
  * @param state State of the font at the beginning of the line.
@@ -888,10 +915,25 @@ Layouter::LineCacheItem &Layouter::GetCachedParagraphLayout(const char *str, siz
 		linecache = new LineCache();
 	}
 
-	LineCacheKey key;
-	key.state_before = state;
-	key.str.assign(str, len);
-	return (*linecache)[key];
+	LineCacheKey key = { &state, str, len };
+	auto iter = linecache->index.find(key);
+	if (iter != linecache->index.end()) {
+		_line_cache_stats.hits++;
+		linecache->items.splice(linecache->items.begin(), linecache->items, iter->second);
+		return *iter->second;
+	}
+
+	_line_cache_stats.misses++;
+	linecache->items.emplace_front();
+	LineCacheItem &item = linecache->items.front();
+	item.state_before = state;
+	item.str.assign(str, len);
+
+	/* The key refers to the copies owned by the item. */
+	key.state_before = &item.state_before;
+	key.str = item.str.data();
+	linecache->index[key] = linecache->items.begin();
+	return item;
 }
 
 /**
@@ -899,16 +941,56 @@ Layouter::LineCacheItem &Layouter::GetCachedParagraphLayout(const char *str, siz
  */
 void Layouter::ResetLineCache()
 {
-	if (linecache != nullptr) linecache->clear();
+	if (linecache != nullptr) {
+		linecache->index.clear();
+		linecache->items.clear();
+		_line_cache_stats.resets++;
+	}
 }
 
 /**
  * Reduce the size of linecache if necessary to prevent infinite growth.
+ * The least recently used lines are evicted until the cache is within its limit again.
  */
 void Layouter::ReduceLineCache()
 {
+	if (linecache == nullptr) return;
+
+	while (linecache->items.size() > LINE_CACHE_MAX_ITEMS) {
+		LineCacheItem &item = linecache->items.back();
+		LineCacheKey key = { &item.state_before, item.str.data(), item.str.size() };
+		linecache->index.erase(key);
+		linecache->items.pop_back();
+		_line_cache_stats.evictions++;
+	}
+}
+
+/**
+ * Write the statistics of the linecache into a buffer.
+ * @param b Buffer to write to.
+ * @param last Last valid byte of \a b.
+ */
+void Layouter::DumpLineCacheStats(char *b, const char *last)
+{
+	const LineCacheStats &st = _line_cache_stats;
+	uint64 lookups = st.hits + st.misses;
+	size_t bytes = 0;
+	size_t items = 0;
 	if (linecache != nullptr) {
-		/* TODO LRU cache would be fancy, but not exactly necessary */
-		if (linecache->size() > 4096) ResetLineCache();
+		items = linecache->items.size();
+		for (const LineCacheItem &item : linecache->items) bytes += item.str.size();
 	}
+
+	b += seprintf(b, last, "Line cache: %u items (limit %u), %u string bytes\n", (uint)items, (uint)LINE_CACHE_MAX_ITEMS, (uint)bytes);
+	b += seprintf(b, last, "  lookups: " OTTD_PRINTF64U ", hits: " OTTD_PRINTF64U " (%u.%u%%), misses: " OTTD_PRINTF64U "\n",
+			lookups, st.hits, lookups > 0 ? (uint)(st.hits * 100 / lookups) : 0, lookups > 0 ? (uint)((st.hits * 1000 / lookups) % 10) : 0, st.misses);
+	b += seprintf(b, last, "  evictions: " OTTD_PRINTF64U ", resets: " OTTD_PRINTF64U "\n", st.evictions, st.resets);
+}
+
+/**
+ * Reset the statistics of the linecache.
+ */
+void Layouter::ResetLineCacheStats()
+{
+	_line_cache_stats = LineCacheStats();
 }
@@ -16,9 +16,11 @@
 #include "gfx_func.h"
 #include "core/smallmap_type.hpp"
 
+#include <list>
 #include <map>
 #include <string>
 #include <stack>
+#include <unordered_map>
 #include <vector>
 
 #ifdef WITH_ICU_LX
@@ -153,23 +155,12 @@ public:
 class Layouter : public std::vector<std::unique_ptr<const ParagraphLayouter::Line>> {
 	const char *string; ///< Pointer to the original string.
 
-	/** Key into the linecache */
-	struct LineCacheKey {
-		FontState state_before;  ///< Font state at the beginning of the line.
-		std::string str;         ///< Source string of the line (including colour and font size codes).
-
-		/** Comparison operator for std::map */
-		bool operator<(const LineCacheKey &other) const
-		{
-			if (this->state_before.fontsize != other.state_before.fontsize) return this->state_before.fontsize < other.state_before.fontsize;
-			if (this->state_before.cur_colour != other.state_before.cur_colour) return this->state_before.cur_colour < other.state_before.cur_colour;
-			if (this->state_before.colour_stack != other.state_before.colour_stack) return this->state_before.colour_stack < other.state_before.colour_stack;
-			return this->str < other.str;
-		}
-	};
 public:
 	/** Item in the linecache */
 	struct LineCacheItem {
+		FontState state_before;    ///< Font state at the beginning of the line.
+		std::string str;           ///< Source string of the line (including colour and font size codes), owned by the cache.
+
 		/* Stuff that cannot be freed until the ParagraphLayout is freed */
 		void *buffer;              ///< Accessed by both ICU's and our ParagraphLayout::nextLine.
 		FontMap runs;              ///< Accessed by our ParagraphLayout::nextLine.
@@ -181,7 +172,39 @@ public:
 		~LineCacheItem() { delete layout; free(buffer); }
 	};
 private:
-	typedef std::map<LineCacheKey, LineCacheItem> LineCache;
+	/**
+	 * Key into the linecache.
+	 * The key does not own any data; for entries in the cache it points at the
+	 * state and string stored in the LineCacheItem, for lookups it points at the
+	 * caller's data, so a lookup never copies the string.
+	 */
+	struct LineCacheKey {
+		const FontState *state_before; ///< Font state at the beginning of the line.
+		const char *str;               ///< Source string of the line (not terminated).
+		size_t len;                    ///< Length of \a str in bytes.
+
+		bool operator==(const LineCacheKey &other) const
+		{
+			if (this->len != other.len) return false;
+			if (this->state_before->fontsize != other.state_before->fontsize) return false;
+			if (this->state_before->cur_colour != other.state_before->cur_colour) return false;
+			if (this->state_before->colour_stack != other.state_before->colour_stack) return false;
+			return memcmp(this->str, other.str, this->len) == 0;
+		}
+	};
+
+	/** Hash function for LineCacheKey */
+	struct LineCacheKeyHash {
+		size_t operator()(const LineCacheKey &key) const;
+	};
+
+	typedef std::list<LineCacheItem> LineCacheList; ///< Cache items, most recently used first.
+
+	/** Size bounded LRU cache of line layouts. */
+	struct LineCache {
+		LineCacheList items; ///< All cached items, in order of last use.
+		std::unordered_map<LineCacheKey, LineCacheList::iterator, LineCacheKeyHash> index; ///< Lookup of the items.
+	};
 	static LineCache *linecache;
 
 	static LineCacheItem &GetCachedParagraphLayout(const char *str, size_t len, const FontState &state);
@@ -199,6 +222,8 @@ public:
 	static void ResetFontCache(FontSize size);
 	static void ResetLineCache();
 	static void ReduceLineCache();
+	static void DumpLineCacheStats(char *b, const char *last);
+	static void ResetLineCacheStats();
 };
 
 #endif /* GFX_LAYOUT_H */
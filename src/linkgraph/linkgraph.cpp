@@ -46,6 +46,54 @@ inline void LinkGraph::BaseEdge::Init()
 	this->next_edge = INVALID_NODE;
 }
 
+/**
+ * Make a row of the matrix and the vector of rows exclusive to this matrix
+ * by copying them if they are shared with another one.
+ * @param x ID of the row.
+ */
+void LinkGraph::EdgeMatrix::Unshare(uint x)
+{
+	if (this->rows.use_count() != 1) this->rows = std::make_shared<RowVector>(*this->rows);
+	std::shared_ptr<Row> &row = (*this->rows)[x];
+	if (row.use_count() != 1) row = std::make_shared<Row>(*row);
+}
+
+/**
+ * Resize the matrix. Existing edges are kept, new ones are uninitialized.
+ * @param new_width New number of rows.
+ * @param new_height New number of edges in each row.
+ */
+void LinkGraph::EdgeMatrix::Resize(uint new_width, uint new_height)
+{
+	if (this->rows.use_count() != 1) this->rows = std::make_shared<RowVector>(*this->rows);
+	RowVector &rows = *this->rows;
+	if (new_height != this->height) {
+		for (uint x = 0; x < min<uint>(new_width, (uint)rows.size()); ++x) {
+			this->Unshare(x);
+			rows[x]->resize(new_height);
+		}
+		this->height = new_height;
+	}
+	if (new_width < rows.size()) {
+		rows.resize(new_width);
+	} else {
+		while (rows.size() < new_width) rows.push_back(std::make_shared<Row>(new_height));
+	}
+}
+
+/**
+ * Remove a row from the matrix by replacing it with the last one.
+ * @param x ID of the row to be removed.
+ */
+void LinkGraph::EdgeMatrix::EraseColumn(uint x)
+{
+	if (this->rows.use_count() != 1) this->rows = std::make_shared<RowVector>(*this->rows);
+	RowVector &rows = *this->rows;
+	assert(x < rows.size());
+	rows[x] = rows.back();
+	rows.pop_back();
+}
+
 /**
  * Shift all dates by given interval.
  * This is useful if the date has been modified with the cheat menu.
@@ -88,6 +136,8 @@ void LinkGraph::Merge(LinkGraph *other)
 {
 	Date age = _date - this->last_compression + 1;
 	Date other_age = _date - other->last_compression + 1;
+	/* Only read the other graph's edges, so that rows shared with a job aren't copied. */
+	const EdgeMatrix &other_edges = other->edges;
 	NodeID first = this->Size();
 	for (NodeID node1 = 0; node1 < other->Size(); ++node1) {
 		Station *st = Station::Get(other->nodes[node1].station);
@@ -98,8 +148,8 @@ void LinkGraph::Merge(LinkGraph *other)
 		for (NodeID node2 = 0; node2 < node1; ++node2) {
 			BaseEdge &forward = this->edges[new_node][first + node2];
 			BaseEdge &backward = this->edges[first + node2][new_node];
-			forward = other->edges[node1][node2];
-			backward = other->edges[node2][node1];
+			forward = other_edges[node1][node2];
+			backward = other_edges[node2][node1];
 			forward.capacity = LinkGraph::Scale(forward.capacity, age, other_age);
 			forward.usage = LinkGraph::Scale(forward.usage, age, other_age);
 			if (forward.next_edge != INVALID_NODE) forward.next_edge += first;
@@ -108,7 +158,7 @@ void LinkGraph::Merge(LinkGraph *other)
 			if (backward.next_edge != INVALID_NODE) backward.next_edge += first;
 		}
 		BaseEdge &new_start = this->edges[new_node][new_node];
-		new_start = other->edges[node1][node1];
+		new_start = other_edges[node1][node1];
 		if (new_start.next_edge != INVALID_NODE) new_start.next_edge += first;
 	}
 	delete other;
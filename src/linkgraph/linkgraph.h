@@ -20,6 +20,8 @@
 #include "../cargotype.h"
 #include "../date_func.h"
 #include "linkgraph_type.h"
+#include <memory>
+#include <vector>
 
 struct SaveLoad;
 class LinkGraph;
@@ -437,7 +439,67 @@ public:
 	};
 
 	typedef std::vector<BaseNode> NodeVector;
-	typedef SmallMatrix<BaseEdge> EdgeMatrix;
+
+	/**
+	 * Matrix of edges, stored as one row of outgoing edges per node. Copies of
+	 * the matrix share their rows, so a link graph job takes a snapshot of the
+	 * edges in O(1). Changing a shared row copies it first, so updates on the
+	 * main thread while a job is running only copy the rows they touch. The
+	 * const accessors never copy anything and are safe to use from the job's
+	 * thread.
+	 */
+	class EdgeMatrix {
+	public:
+		EdgeMatrix() : rows(std::make_shared<RowVector>()), height(0) {}
+
+		/**
+		 * Get the outgoing edges of a node for reading.
+		 * @param x ID of the node.
+		 * @return Array of Height() edges.
+		 */
+		inline const BaseEdge *operator[](uint x) const
+		{
+			assert(x < this->rows->size());
+			return (*this->rows)[x]->data();
+		}
+
+		/**
+		 * Get the outgoing edges of a node for changing them. The row is
+		 * copied first if it is shared with another matrix.
+		 * @param x ID of the node.
+		 * @return Array of Height() edges.
+		 */
+		inline BaseEdge *operator[](uint x)
+		{
+			assert(x < this->rows->size());
+			if (this->rows.use_count() != 1 || (*this->rows)[x].use_count() != 1) this->Unshare(x);
+			return (*this->rows)[x]->data();
+		}
+
+		/**
+		 * Get the number of rows, i.e. nodes, in the matrix.
+		 * @return Width of the matrix.
+		 */
+		inline uint Width() const { return (uint)this->rows->size(); }
+
+		/**
+		 * Get the number of edges in each row.
+		 * @return Height of the matrix.
+		 */
+		inline uint Height() const { return this->height; }
+
+		void Resize(uint new_width, uint new_height);
+		void EraseColumn(uint x);
+
+	private:
+		typedef std::vector<BaseEdge> Row;
+		typedef std::vector<std::shared_ptr<Row>> RowVector;
+
+		std::shared_ptr<RowVector> rows; ///< Rows of the matrix, possibly shared with other matrices.
+		uint height;                     ///< Number of edges in each row.
+
+		void Unshare(uint x);
+	};
 
 	/** Minimum effective distance for timeout calculation. */
 	static const uint MIN_TIMEOUT_DISTANCE = 32;
@@ -63,7 +63,7 @@ private:
 	friend class LinkGraphJobGroup;
 
 protected:
-	const LinkGraph link_graph;       ///< Link graph to by analyzed. Is copied when job is started and mustn't be modified later.
+	const LinkGraph link_graph;       ///< Link graph to by analyzed. Is copied when job is started, sharing the edges with the original, and mustn't be modified later.
 	std::shared_ptr<LinkGraphJobGroup> group; ///< JOb group thread the job is running in or nullptr if it's running in the main thread.
 	const LinkGraphSettings settings; ///< Copy of _settings_game.linkgraph at spawn time.
 	DateTicks join_date_ticks;        ///< Date when the job is to be joined.
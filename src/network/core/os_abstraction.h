@@ -85,6 +85,11 @@ typedef unsigned long in_addr_t;
 #		include <ifaddrs.h>
 #		define HAVE_GETIFADDRS
 #	endif
+/* Linux can notify about socket readiness without passing all sockets on every call. */
+#	if defined(__linux__)
+#		include <sys/epoll.h>
+#		define HAVE_EPOLL
+#	endif
 #	if !defined(INADDR_NONE)
 #		define INADDR_NONE 0xffffffff
 #	endif
@@ -88,8 +88,8 @@ void NetworkTCPSocketHandler::SendPacket(Packet *packet)
  * Sends all the buffered packets out for this client. It stops when:
  *   1) all packets are send (queue is empty)
  *   2) the OS reports back that it can not send any more
- *      data right now (full network-buffer, it happens ;))
- *   3) sending took too long
+ *      data right now (full network-buffer, it happens ;)),
+ *      this also clears #writable
  * @param closing_down Whether we are closing down the connection.
  * @return \c true if a (part of a) packet could be sent and
  *         the connection is not closed yet.
@@ -116,6 +116,10 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 				}
 				return SPS_CLOSED;
 			}
+			/* The network buffer is full. Listeners using edge-triggered
+			 * notifications only mark the socket writable again once there
+			 * is room, so the buffer has to be filled up to this point. */
+			this->writable = false;
 			return SPS_PARTLY_SENT;
 		}
 		if (res == 0) {
@@ -126,14 +130,12 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 
 		p->pos += res;
 
-		/* Is this packet sent? */
+		/* Is this packet sent? Otherwise try to send the rest of it. */
 		if (p->pos == p->size) {
 			/* Go to the next packet */
 			this->packet_queue = p->next;
 			delete p;
 			p = this->packet_queue;
-		} else {
-			return SPS_PARTLY_SENT;
 		}
 	}
 
@@ -31,6 +31,112 @@ class TCPListenHandler {
 	/** List of sockets we listen on. */
 	static SocketList sockets;
 
+#ifdef HAVE_EPOLL
+	/** Marker for the listening sockets in the upper half of the epoll event data. */
+	static const uint32 EPOLL_LISTENER = UINT32_MAX;
+
+	/** Level-triggered read readiness of the listening and accepted sockets, or -1 when select is used. */
+	static int epoll_read;
+	/** Edge-triggered write readiness of the accepted sockets, or -1 when select is used. */
+	static int epoll_write;
+
+	/**
+	 * Create the epoll instances, unless that was already done.
+	 * They are kept until the game exits, as accepted sockets may outlive the listeners.
+	 * @return true if epoll can be used.
+	 */
+	static bool InitEpoll()
+	{
+		if (epoll_read != -1) return true;
+
+		int r = epoll_create1(EPOLL_CLOEXEC);
+		int w = epoll_create1(EPOLL_CLOEXEC);
+		if (r == -1 || w == -1) {
+			DEBUG(net, 0, "[%s] epoll_create1 failed with error %d, using select", Tsocket::GetName(), GET_LAST_ERROR());
+			if (r != -1) close(r);
+			if (w != -1) close(w);
+			return false;
+		}
+		epoll_read = r;
+		epoll_write = w;
+		return true;
+	}
+
+	/**
+	 * Register a socket with the epoll instances.
+	 * Sockets are removed from them automatically when they are closed.
+	 * @param s The socket.
+	 * @param index Pool index of the socket handler, or #EPOLL_LISTENER.
+	 */
+	static void EpollAdd(SOCKET s, uint32 index)
+	{
+		struct epoll_event ev;
+		ev.data.u64 = (((uint64) index) << 32) | (uint32) s;
+
+		ev.events = EPOLLIN;
+		if (epoll_ctl(epoll_read, EPOLL_CTL_ADD, s, &ev) != 0) {
+			DEBUG(net, 0, "[%s] epoll_ctl failed with error %d", Tsocket::GetName(), GET_LAST_ERROR());
+		}
+		if (index == EPOLL_LISTENER) return;
+
+		ev.events = EPOLLOUT | EPOLLET;
+		if (epoll_ctl(epoll_write, EPOLL_CTL_ADD, s, &ev) != 0) {
+			DEBUG(net, 0, "[%s] epoll_ctl failed with error %d", Tsocket::GetName(), GET_LAST_ERROR());
+		}
+	}
+
+	/**
+	 * Get the socket handler an epoll event is for.
+	 * @param data The event data.
+	 * @return The socket handler, or nullptr if it is gone or no longer uses that socket.
+	 */
+	static Tsocket *GetEpollSocket(uint64 data)
+	{
+		uint32 index = GB(data, 32, 32);
+		if (!Tsocket::IsValidID(index)) return nullptr;
+		Tsocket *cs = Tsocket::Get(index);
+		return cs->sock == (SOCKET) GB(data, 0, 32) ? cs : nullptr;
+	}
+
+	/**
+	 * Handle the receiving of packets using epoll, only visiting the sockets that are ready.
+	 * Sockets stay writable until SendPackets fills their network buffer.
+	 * @return true if everything went okay.
+	 */
+	static bool ReceiveEpoll()
+	{
+		struct epoll_event events[256];
+
+		for (;;) {
+			int n = epoll_wait(epoll_write, events, lengthof(events), 0);
+			if (n < 0) {
+				if (GET_LAST_ERROR() == EINTR) break;
+				return false;
+			}
+			for (int i = 0; i < n; i++) {
+				Tsocket *cs = GetEpollSocket(events[i].data.u64);
+				if (cs != nullptr) cs->writable = true;
+			}
+			if (n < (int) lengthof(events)) break;
+		}
+
+		/* Read readiness is level-triggered, sockets not handled in this frame are reported again in the next one. */
+		int n = epoll_wait(epoll_read, events, lengthof(events), 0);
+		if (n < 0) return GET_LAST_ERROR() == EINTR ? _networking : false;
+
+		for (int i = 0; i < n; i++) {
+			uint64 data = events[i].data.u64;
+			if (GB(data, 32, 32) == EPOLL_LISTENER) {
+				AcceptClient((SOCKET) GB(data, 0, 32));
+				continue;
+			}
+			Tsocket *cs = GetEpollSocket(data);
+			if (cs != nullptr) cs->ReceivePackets();
+		}
+		return _networking;
+	}
+#endif /* HAVE_EPOLL */
+
 public:
 	/**
 	 * Accepts clients from the sockets.
@@ -87,7 +193,12 @@ public:
 				continue;
 			}
 
+#ifdef HAVE_EPOLL
+			Tsocket *cs = Tsocket::AcceptConnection(s, address);
+			if (epoll_read != -1) EpollAdd(s, cs->index);
+#else
 			Tsocket::AcceptConnection(s, address);
+#endif
 		}
 	}
 
@@ -97,6 +208,10 @@ public:
 	 */
 	static bool Receive()
 	{
+#ifdef HAVE_EPOLL
+		if (epoll_read != -1) return ReceiveEpoll();
+#endif
+
 		fd_set read_fd, write_fd;
 		struct timeval tv;
 
@@ -155,6 +270,14 @@ public:
 			return false;
 		}
 
+#ifdef HAVE_EPOLL
+		if (InitEpoll()) {
+			for (auto &s : sockets) {
+				EpollAdd(s.second, EPOLL_LISTENER);
+			}
+		}
+#endif
+
 		return true;
 	}
 
@@ -170,5 +293,9 @@ public:
 };
 
 template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> SocketList TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::sockets;
+#ifdef HAVE_EPOLL
+template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> int TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::epoll_read = -1;
+template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> int TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::epoll_write = -1;
+#endif /* HAVE_EPOLL */
 
 #endif /* NETWORK_CORE_TCP_LISTEN_H */
@@ -13,6 +13,14 @@
 
 #include <stdarg.h>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+# include <unistd.h>
+#endif /* _WIN32 */
 
 #include "debug.h"
 #include "fileio_func.h"
@@ -48,6 +56,7 @@
 #include "vehicle_func.h"
 #include "language.h"
 #include "vehicle_base.h"
+#include "thread.h"
 
 #include "table/strings.h"
 #include "table/build_industry.h"
@@ -4990,6 +4999,9 @@ static void NewSpriteGroup(ByteReader *buf)
 				group->ranges = MallocT<DeterministicSpriteGroupRange>(group->num_ranges);
 				MemCpyT(group->ranges, &optimised.front(), group->num_ranges);
 			}
+
+			group->Optimise();
+			group->ClassifyInputs();
 			break;
 		}
 
@@ -8904,6 +8916,7 @@ void ResetNewGRFData()
 
 	InitializeSoundPool();
 	_spritegroup_pool.CleanPool();
+	InvalidateDeterministicSpriteGroupResultCache();
 }
 
 /**
@@ -9492,7 +9505,7 @@ static void FinaliseAirportsArray()
  * XXX: We consider GRF files trusted. It would be trivial to exploit OTTD by
  * a crafted invalid GRF file. We should tell that to the user somehow, or
  * better make this more robust in the future. */
-static void DecodeSpecialSprite(byte *buf, uint num, GrfLoadingStage stage)
+static void DecodeSpecialSprite(byte *buf, uint num, GrfLoadingStage stage, const byte *data)
 {
 	/* XXX: There is a difference between staged loading in TTDPatch and
 	 * here.  In TTDPatch, for some reason actions 1 and 2 are carried out
@@ -9536,14 +9549,18 @@ static void DecodeSpecialSprite(byte *buf, uint num, GrfLoadingStage stage)
 	if (it == _grf_line_to_action6_sprite_override.end()) {
 		/* No preloaded sprite to work with; read the
 		 * pseudo sprite content. */
-		FioReadBlock(buf, num);
+		if (data != nullptr) {
+			MemCpyT(buf, data, num);
+		} else {
+			FioReadBlock(buf, num);
+		}
 	} else {
 		/* Use the preloaded sprite data. */
 		buf = it->second;
 		grfmsg(7, "DecodeSpecialSprite: Using preloaded pseudo sprite data");
 
 		/* Skip the real (original) content of this action. */
-		FioSeekTo(num, SEEK_CUR);
+		if (data == nullptr) FioSeekTo(num, SEEK_CUR);
 	}
 
 	ByteReader br(buf, buf + num);
@@ -9597,6 +9614,589 @@ byte GetGRFContainerVersion()
 	return 1;
 }
 
+/**
+ * Buffered reader of a GRF for #GRFSpriteIndex, so indexing does not need the whole file in memory.
+ * Reading beyond the end of the GRF throws #OTTDByteReaderSignal, like #ByteReader.
+ */
+class GRFSpriteIndexReader {
+	static const size_t BUFFER_SIZE = 64 * 1024; ///< Size of the read buffer.
+
+	FILE *f;                          ///< The file, positioned at the start of the GRF when constructed.
+	size_t base;                      ///< File position of the start of the GRF.
+	size_t size;                      ///< Size of the GRF.
+	size_t buffer_pos;                ///< Position in the GRF of the start of the buffer.
+	byte *pos;                        ///< Current position in the buffer.
+	byte *end;                        ///< End of the valid data in the buffer.
+	std::unique_ptr<byte[]> buffer;   ///< The read buffer.
+
+	/** Refill the buffer from the current position, which must be at the end of the buffer. */
+	void Fill()
+	{
+		this->buffer_pos += this->end - this->buffer.get();
+		size_t n = min(BUFFER_SIZE, this->size - min(this->buffer_pos, this->size));
+		if (n == 0 || fread(this->buffer.get(), 1, n, this->f) != n) throw OTTDByteReaderSignal();
+		this->pos = this->buffer.get();
+		this->end = this->pos + n;
+	}
+
+public:
+	/**
+	 * Create a reader.
+	 * @param f The file, positioned at the start of the GRF.
+	 * @param base File position of the start of the GRF.
+	 * @param size Size of the GRF.
+	 */
+	GRFSpriteIndexReader(FILE *f, size_t base, size_t size) : f(f), base(base), size(size), buffer_pos(0), buffer(new byte[BUFFER_SIZE])
+	{
+		this->pos = this->end = this->buffer.get();
+	}
+
+	/** Get the position in the GRF. */
+	size_t GetPos() const { return this->buffer_pos + (this->pos - this->buffer.get()); }
+
+	/** Get the number of bytes left in the GRF. */
+	size_t Remaining() const { return this->size - this->GetPos(); }
+
+	inline byte ReadByte()
+	{
+		if (this->pos == this->end) this->Fill();
+		return *this->pos++;
+	}
+
+	uint16 ReadWord()
+	{
+		uint16 val = this->ReadByte();
+		return val | (this->ReadByte() << 8);
+	}
+
+	uint32 ReadDWord()
+	{
+		uint32 val = this->ReadWord();
+		return val | (this->ReadWord() << 16);
+	}
+
+	/**
+	 * Copy bytes from the GRF.
+	 * @param dest Destination of the bytes.
+	 * @param len Number of bytes.
+	 */
+	void Read(byte *dest, size_t len)
+	{
+		if (len > this->Remaining()) throw OTTDByteReaderSignal();
+		while (len > 0) {
+			if (this->pos == this->end) this->Fill();
+			size_t n = min<size_t>(len, this->end - this->pos);
+			memcpy(dest, this->pos, n);
+			this->pos += n;
+			dest += n;
+			len -= n;
+		}
+	}
+
+	/**
+	 * Go to a position in the GRF; positions outside the buffer are sought in the file.
+	 * @param target The position.
+	 */
+	void SeekTo(size_t target)
+	{
+		if (target > this->size) throw OTTDByteReaderSignal();
+		if (target >= this->buffer_pos && target <= this->buffer_pos + (this->end - this->buffer.get())) {
+			this->pos = this->buffer.get() + (target - this->buffer_pos);
+			return;
+		}
+		if (fseek(this->f, (long)(this->base + target), SEEK_SET) != 0) throw OTTDByteReaderSignal();
+		this->buffer_pos = target;
+		this->pos = this->end = this->buffer.get();
+	}
+
+	void Skip(size_t len)
+	{
+		if (len > this->Remaining()) throw OTTDByteReaderSignal();
+		this->SeekTo(this->GetPos() + len);
+	}
+};
+
+/** A record in the data section of a GRF, see #GRFSpriteIndex. */
+struct GRFSpriteIndexEntry {
+	size_t pos;      ///< File position of the record, i.e. of its size field.
+	size_t next_pos; ///< File position of the next record.
+	uint32 num;      ///< Size of the record as stored in the file, 0 for the end of the data section.
+	byte type;       ///< Type of the record, 0xFF for pseudo sprites.
+	size_t data;     ///< Offset of the contents of a pseudo sprite in GRFSpriteIndex::data.
+};
+
+/**
+ * In-memory index of the data section of a GRF.
+ * It is built once before the loading stages, in parallel for all GRFs, so the
+ * stages neither have to read pseudo sprites from disk again and again, nor have
+ * to decode real sprites just to skip them.
+ */
+struct GRFSpriteIndex {
+	std::vector<GRFSpriteIndexEntry> entries;              ///< Records of the data section ordered by position, up to the end marker.
+	std::vector<byte> data;                                ///< Contents of the pseudo sprites.
+	std::vector<std::pair<uint32, size_t>> sprite_offsets; ///< Sprite IDs and their positions in the sprite section in file order, see #ReadGRFSpriteOffsets.
+
+	bool from_cache = false;                               ///< Whether the index was read from the cache file.
+	bool cache_write_failed = false;                       ///< Whether writing the cache file failed, reported by the main thread.
+
+	bool Build(const char *filename, Subdirectory subdir, const uint8 *md5sum);
+	const GRFSpriteIndexEntry *Find(size_t pos, const GRFSpriteIndexEntry *hint) const;
+
+private:
+	bool Parse(GRFSpriteIndexReader &reader, size_t base);
+	bool LoadCache(const char *cache_name, size_t size, size_t base, uint64 mtime, uint64 *cache_mtime);
+	bool SaveCache(const char *cache_name, size_t size, size_t base, uint64 mtime) const;
+};
+
+/**
+ * Skip the data of a real sprite while indexing, like #SkipSpriteData.
+ * @param buf Reader positioned at the sprite data.
+ * @param type Type of the sprite.
+ * @param num Size of the sprite data.
+ * @return False if the data is invalid.
+ */
+static bool SkipSpriteData(GRFSpriteIndexReader &buf, byte type, uint16 num)
+{
+	if (type & 2) {
+		buf.Skip(num);
+	} else {
+		while (num > 0) {
+			int8 i = buf.ReadByte();
+			if (i >= 0) {
+				int size = (i == 0) ? 0x80 : i;
+				if (size > num) return false;
+				num -= size;
+				buf.Skip(size);
+			} else {
+				i = -(i >> 3);
+				num -= i;
+				buf.ReadByte();
+			}
+		}
+	}
+	return true;
+}
+
+/** Subdirectory of the personal directory for cached GRF indices. */
+#define GRF_SPRITE_INDEX_CACHE_DIR "cache"
+/** Magic at the start of a GRF index cache file. */
+static const byte GRF_SPRITE_INDEX_CACHE_MAGIC[8] = {'O', 'T', 'T', 'D', 'G', 'R', 'F', 'I'};
+/** Version of the GRF index cache files, increase when changing their format or the contents of the index. */
+static const uint32 GRF_SPRITE_INDEX_CACHE_VERSION = 2;
+/** Age in seconds after which a cache file that is used is written again, so it does not expire. */
+static const uint64 GRF_SPRITE_INDEX_CACHE_REFRESH_AGE = 7 * 24 * 60 * 60;
+/** Age in seconds after which a cache file is removed; its GRF has not been loaded for that long, or is gone. */
+static const uint64 GRF_SPRITE_INDEX_CACHE_MAX_AGE = 30 * 24 * 60 * 60;
+
+/**
+ * Get the time an open file was last modified.
+ * @param f The file.
+ * @return The modification time, or 0 if it is unknown.
+ */
+static uint64 GetFileModificationTime(FILE *f)
+{
+#ifdef _WIN32
+	struct _stat sb;
+	if (_fstat(_fileno(f), &sb) != 0) return 0;
+#else
+	struct stat sb;
+	if (fstat(fileno(f), &sb) != 0) return 0;
+#endif
+	return (uint64)sb.st_mtime;
+}
+
+/**
+ * Get the name of the cache file of the index of a GRF.
+ * @param buf Buffer to write the name to.
+ * @param last Last valid byte of \a buf.
+ * @param md5sum MD5 checksum of the GRF.
+ * @return False if the index of this GRF can not be cached.
+ */
+static bool GetGRFSpriteIndexCacheName(char *buf, const char *last, const uint8 *md5sum)
+{
+	static const uint8 no_md5sum[16] = {};
+	if (_personal_dir == nullptr || memcmp(md5sum, no_md5sum, sizeof(no_md5sum)) == 0) return false;
+
+	buf += seprintf(buf, last, "%s" GRF_SPRITE_INDEX_CACHE_DIR PATHSEP, _personal_dir);
+	buf = md5sumToString(buf, last, md5sum);
+	seprintf(buf, last, ".grfidx");
+	return true;
+}
+
+/**
+ * Read a GRF and index its data section.
+ * If the index of the GRF was cached before, the cached index is used instead.
+ * @param filename Name of the GRF.
+ * @param subdir Subdirectory to find the GRF in.
+ * @param md5sum MD5 checksum of the GRF, used as key of the cache.
+ * @return False if the file can not be read or is not a valid GRF; the loading stages then read it from disk.
+ */
+bool GRFSpriteIndex::Build(const char *filename, Subdirectory subdir, const uint8 *md5sum)
+{
+	size_t size;
+	FILE *f = FioFOpenFile(filename, "rb", subdir, &size);
+	if (f == nullptr) return false;
+
+	/* Positions in the index must match those of the Fio functions, which are relative to the start of a containing tar. */
+	long base = ftell(f);
+	if (base < 0) {
+		FioFCloseFile(f);
+		return false;
+	}
+
+	/* A GRF in a tar gets the time of the tar, which changes whenever the GRF does. */
+	uint64 mtime = GetFileModificationTime(f);
+
+	char cache_name[MAX_PATH];
+	bool cacheable = GetGRFSpriteIndexCacheName(cache_name, lastof(cache_name), md5sum);
+	if (cacheable) {
+		uint64 cache_mtime;
+		if (this->LoadCache(cache_name, size, base, mtime, &cache_mtime)) {
+			FioFCloseFile(f);
+			this->from_cache = true;
+			if ((uint64)time(nullptr) > cache_mtime + GRF_SPRITE_INDEX_CACHE_REFRESH_AGE) {
+				this->cache_write_failed = !this->SaveCache(cache_name, size, base, mtime);
+			}
+			return true;
+		}
+		*this = GRFSpriteIndex();
+	}
+
+	GRFSpriteIndexReader reader(f, base, size);
+	bool parsed = this->Parse(reader, base);
+	FioFCloseFile(f);
+	if (!parsed) return false;
+
+	if (cacheable) this->cache_write_failed = !this->SaveCache(cache_name, size, base, mtime);
+	return true;
+}
+
+/**
+ * Index the data section of a GRF.
+ * Only the pseudo sprites are kept; real sprites are skipped, and of the
+ * sprite section of container version 2 only the sprite headers are read.
+ * @param reader Reader of the GRF.
+ * @param base File position of the start of the GRF.
+ * @return False if the GRF is not valid.
+ */
+bool GRFSpriteIndex::Parse(GRFSpriteIndexReader &reader, size_t base)
+{
+	try {
+		byte container_version = 1;
+		if (reader.ReadWord() == 0) {
+			for (uint i = 0; i < lengthof(_grf_cont_v2_sig); i++) {
+				if (reader.ReadByte() != _grf_cont_v2_sig[i]) return false;
+			}
+			container_version = 2;
+		} else {
+			reader.SeekTo(0);
+		}
+
+		size_t sprite_section = 0;
+		if (container_version >= 2) {
+			uint32 data_offset = reader.ReadDWord();
+			sprite_section = reader.GetPos() + data_offset;
+			if (reader.ReadByte() != 0) return false; // compression
+		}
+
+		/* Header sprite. */
+		uint32 num = container_version >= 2 ? reader.ReadDWord() : reader.ReadWord();
+		if (num != 4 || reader.ReadByte() != 0xFF) return false;
+		reader.ReadDWord();
+
+		for (;;) {
+			GRFSpriteIndexEntry entry;
+			entry.pos = base + reader.GetPos();
+			entry.num = container_version >= 2 ? reader.ReadDWord() : reader.ReadWord();
+			entry.type = 0;
+			entry.data = 0;
+			if (entry.num != 0) {
+				entry.type = reader.ReadByte();
+				if (entry.type == 0xFF) {
+					if (entry.num > reader.Remaining()) return false;
+					entry.data = this->data.size();
+					this->data.resize(entry.data + entry.num);
+					reader.Read(this->data.data() + entry.data, entry.num);
+				} else if (container_version >= 2 && entry.type == 0xFD) {
+					reader.Skip(entry.num);
+				} else {
+					reader.Skip(7);
+					if (!SkipSpriteData(reader, entry.type, entry.num - 8)) return false;
+				}
+			}
+			entry.next_pos = base + reader.GetPos();
+			this->entries.push_back(entry);
+			if (entry.num == 0) break;
+		}
+
+		if (container_version >= 2) {
+			reader.SeekTo(sprite_section);
+			uint32 id, prev_id = 0;
+			while ((id = reader.ReadDWord()) != 0) {
+				if (id != prev_id) this->sprite_offsets.emplace_back(id, base + reader.GetPos() - 4);
+				prev_id = id;
+				reader.Skip(reader.ReadDWord());
+			}
+		}
+	} catch (...) {
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Read a 64 bit value, as written by #GRFSpriteIndex::SaveCache.
+ * @param buf Reader to read from.
+ * @return The value.
+ */
+static uint64 ReadGRFSpriteIndexCacheQWord(ByteReader &buf)
+{
+	uint64 low = buf.ReadDWord();
+	return low | ((uint64)buf.ReadDWord() << 32);
+}
+
+/**
+ * Read the index from its cache file.
+ * @param cache_name Name of the cache file.
+ * @param size Size of the GRF, which must match the size when the cache was written.
+ * @param base File position of the start of the GRF, which must match as well.
+ * @param mtime Modification time of the GRF, which must match as well.
+ * @param[out] cache_mtime Modification time of the cache file.
+ * @return False if there is no valid cache file; the index may be partially filled then.
+ */
+bool GRFSpriteIndex::LoadCache(const char *cache_name, size_t size, size_t base, uint64 mtime, uint64 *cache_mtime)
+{
+	size_t cache_size;
+	FILE *f = FioFOpenFile(cache_name, "rb", NO_DIRECTORY, &cache_size);
+	if (f == nullptr) return false;
+
+	*cache_mtime = GetFileModificationTime(f);
+	std::vector<byte> cache(cache_size);
+	bool read = fread(cache.data(), 1, cache_size, f) == cache_size;
+	FioFCloseFile(f);
+	if (!read) return false;
+
+	ByteReader buf(cache.data(), cache.data() + cache_size);
+	try {
+		for (uint i = 0; i < lengthof(GRF_SPRITE_INDEX_CACHE_MAGIC); i++) {
+			if (buf.ReadByte() != GRF_SPRITE_INDEX_CACHE_MAGIC[i]) return false;
+		}
+		if (buf.ReadDWord() != GRF_SPRITE_INDEX_CACHE_VERSION) return false;
+		if (ReadGRFSpriteIndexCacheQWord(buf) != size || ReadGRFSpriteIndexCacheQWord(buf) != base) return false;
+		if (ReadGRFSpriteIndexCacheQWord(buf) != mtime) return false;
+
+		uint32 num_entries = buf.ReadDWord();
+		uint32 num_offsets = buf.ReadDWord();
+		uint64 data_size = ReadGRFSpriteIndexCacheQWord(buf);
+		if (num_entries == 0) return false;
+
+		this->entries.resize(num_entries);
+		size_t prev_pos = 0;
+		for (GRFSpriteIndexEntry &entry : this->entries) {
+			entry.pos      = (size_t)ReadGRFSpriteIndexCacheQWord(buf);
+			entry.next_pos = (size_t)ReadGRFSpriteIndexCacheQWord(buf);
+			entry.num      = buf.ReadDWord();
+			entry.type     = buf.ReadByte();
+			entry.data     = (size_t)ReadGRFSpriteIndexCacheQWord(buf);
+			/* Find relies on the order, the loading stages on valid pseudo sprite data. */
+			if (entry.pos < prev_pos || entry.next_pos < entry.pos) return false;
+			if (entry.num != 0 && entry.type == 0xFF && entry.data + entry.num > data_size) return false;
+			prev_pos = entry.next_pos;
+		}
+		if (this->entries.back().num != 0) return false;
+
+		this->sprite_offsets.resize(num_offsets);
+		for (auto &offset : this->sprite_offsets) {
+			offset.first  = buf.ReadDWord();
+			offset.second = (size_t)ReadGRFSpriteIndexCacheQWord(buf);
+		}
+
+		if (buf.Remaining() != data_size) return false;
+		this->data.assign(buf.Data(), buf.Data() + data_size);
+	} catch (...) {
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Write the index to its cache file.
+ * Failing to do so is not an error, the index is just built again next time.
+ * @param cache_name Name of the cache file.
+ * @param size Size of the GRF.
+ * @param base File position of the start of the GRF.
+ * @param mtime Modification time of the GRF.
+ * @return False if the cache file could not be written.
+ */
+bool GRFSpriteIndex::SaveCache(const char *cache_name, size_t size, size_t base, uint64 mtime) const
+{
+	std::vector<byte> cache;
+	cache.reserve(72 + this->entries.size() * 29 + this->sprite_offsets.size() * 12 + this->data.size());
+	auto write = [&cache](uint64 value, uint bytes) {
+		for (uint i = 0; i < bytes; i++) cache.push_back(GB(value, i * 8, 8));
+	};
+
+	cache.insert(cache.end(), GRF_SPRITE_INDEX_CACHE_MAGIC, endof(GRF_SPRITE_INDEX_CACHE_MAGIC));
+	write(GRF_SPRITE_INDEX_CACHE_VERSION, 4);
+	write(size, 8);
+	write(base, 8);
+	write(mtime, 8);
+	write(this->entries.size(), 4);
+	write(this->sprite_offsets.size(), 4);
+	write(this->data.size(), 8);
+	for (const GRFSpriteIndexEntry &entry : this->entries) {
+		write(entry.pos, 8);
+		write(entry.next_pos, 8);
+		write(entry.num, 4);
+		write(entry.type, 1);
+		write(entry.data, 8);
+	}
+	for (const auto &offset : this->sprite_offsets) {
+		write(offset.first, 4);
+		write(offset.second, 8);
+	}
+	cache.insert(cache.end(), this->data.begin(), this->data.end());
+
+	FILE *f = FioFOpenFile(cache_name, "wb", NO_DIRECTORY);
+	if (f == nullptr) return false;
+	/* A partially written file is rejected by LoadCache as its size does not match. */
+	bool written = fwrite(cache.data(), 1, cache.size(), f) == cache.size();
+	FioFCloseFile(f);
+	return written;
+}
+
+/** Scanner removing GRF index cache files which have not been written for a long time. */
+class GRFSpriteIndexCachePruner : FileScanner {
+	uint64 now; ///< The current time.
+public:
+	/**
+	 * Remove the expired cache files.
+	 * @param cache_dir Directory of the cache files.
+	 */
+	void Prune(const char *cache_dir)
+	{
+		this->now = (uint64)time(nullptr);
+		uint removed = this->Scan(".grfidx", cache_dir, false);
+		if (removed > 0) DEBUG(grf, 2, "LoadNewGRF: Removed %u expired NewGRF index cache files", removed);
+	}
+
+	bool AddFile(const char *filename, size_t basepath_length, const char *tar_filename) override
+	{
+#ifdef _WIN32
+		struct _stat sb;
+		if (_tstat(OTTD2FS(filename), &sb) != 0) return false;
+#else
+		struct stat sb;
+		if (stat(filename, &sb) != 0) return false;
+#endif
+		if (this->now <= (uint64)sb.st_mtime + GRF_SPRITE_INDEX_CACHE_MAX_AGE) return false;
+		return unlink(filename) == 0;
+	}
+};
+
+/**
+ * Find the record at a file position.
+ * @param pos The file position.
+ * @param hint Record found previously, or \c nullptr. The record at \a pos is usually this one or the next.
+ * @return The record, or \c nullptr if no record starts at \a pos.
+ */
+const GRFSpriteIndexEntry *GRFSpriteIndex::Find(size_t pos, const GRFSpriteIndexEntry *hint) const
+{
+	const GRFSpriteIndexEntry *begin = this->entries.data();
+	const GRFSpriteIndexEntry *end = begin + this->entries.size();
+	if (hint != nullptr) {
+		if (hint->pos == pos) return hint;
+		if (hint + 1 < end && hint[1].pos == pos) return hint + 1;
+	}
+
+	/* Jumps, e.g. to labels of action 10. */
+	const GRFSpriteIndexEntry *entry = std::lower_bound(begin, end, pos, [](const GRFSpriteIndexEntry &e, size_t p) { return e.pos < p; });
+	return (entry != end && entry->pos == pos) ? entry : nullptr;
+}
+
+/** Indices of the GRFs being loaded by #LoadNewGRF. */
+static std::map<const GRFConfig *, std::unique_ptr<GRFSpriteIndex>> _grf_sprite_indices;
+
+/** Maximum number of threads used to index GRFs. */
+static const uint GRF_SPRITE_INDEX_MAX_THREADS = 8;
+
+/** A GRF to index. */
+struct GRFSpriteIndexJob {
+	const GRFConfig *config;               ///< The GRF.
+	Subdirectory subdir;                   ///< Subdirectory to find the GRF in.
+	std::unique_ptr<GRFSpriteIndex> index; ///< The index, if it could be built.
+};
+
+/**
+ * Index GRFs until there are no jobs left.
+ * @param jobs The GRFs to index.
+ * @param next Index of the next job to take.
+ */
+static void BuildGRFSpriteIndexJobs(std::vector<GRFSpriteIndexJob> *jobs, std::atomic<size_t> *next)
+{
+	for (size_t i; (i = (*next)++) < jobs->size();) {
+		GRFSpriteIndexJob &job = (*jobs)[i];
+		std::unique_ptr<GRFSpriteIndex> index(new GRFSpriteIndex());
+		if (index->Build(job.config->filename, job.subdir, job.config->ident.md5sum)) job.index = std::move(index);
+	}
+}
+
+/**
+ * Index the data sections of all GRFs which are to be loaded.
+ * Indexing only reads the files, so it is done on several threads.
+ * @param num_baseset Number of GRFs of the base set, which are at the start of the list.
+ */
+static void BuildGRFSpriteIndices(uint num_baseset)
+{
+	_grf_sprite_indices.clear();
+
+	if (_personal_dir != nullptr) {
+		char cache_dir[MAX_PATH];
+		seprintf(cache_dir, lastof(cache_dir), "%s" GRF_SPRITE_INDEX_CACHE_DIR, _personal_dir);
+		FioCreateDirectory(cache_dir);
+	}
+
+	std::vector<GRFSpriteIndexJob> jobs;
+	for (const GRFConfig *c = _grfconfig; c != nullptr; c = c->next) {
+		if (c->status == GCS_DISABLED || c->status == GCS_NOT_FOUND) continue;
+		GRFSpriteIndexJob job;
+		job.config = c;
+		job.subdir = jobs.size() < num_baseset ? BASESET_DIR : NEWGRF_DIR;
+		jobs.push_back(std::move(job));
+	}
+
+	std::atomic<size_t> next(0);
+	uint threads = Clamp<uint>(std::thread::hardware_concurrency(), 1, GRF_SPRITE_INDEX_MAX_THREADS);
+	threads = min<uint>(threads, (uint)jobs.size());
+	std::vector<std::thread> workers(threads > 1 ? threads - 1 : 0);
+	for (std::thread &worker : workers) {
+		if (!StartNewThread(&worker, "ottd:grfindex", &BuildGRFSpriteIndexJobs, &jobs, &next)) break;
+	}
+	BuildGRFSpriteIndexJobs(&jobs, &next);
+	for (std::thread &worker : workers) {
+		if (worker.joinable()) worker.join();
+	}
+
+	/* Report on the main thread what happened on the worker threads. */
+	uint cached = 0;
+	for (GRFSpriteIndexJob &job : jobs) {
+		if (job.index == nullptr) continue;
+		if (job.index->from_cache) cached++;
+		if (job.index->cache_write_failed) DEBUG(grf, 1, "Could not write NewGRF index cache of '%s'", job.config->filename);
+		_grf_sprite_indices[job.config] = std::move(job.index);
+	}
+	DEBUG(grf, 2, "LoadNewGRF: Indexed %u of %u NewGRFs (%u from cache) using %u threads", (uint)_grf_sprite_indices.size(), (uint)jobs.size(), cached, max(threads, 1U));
+
+	/* Cache files of the GRFs just loaded were refreshed above when needed, so only unused ones expire. */
+	if (_personal_dir != nullptr) {
+		char cache_dir[MAX_PATH];
+		seprintf(cache_dir, lastof(cache_dir), "%s" GRF_SPRITE_INDEX_CACHE_DIR, _personal_dir);
+		GRFSpriteIndexCachePruner().Prune(cache_dir);
+	}
+}
+
 /**
  * Load a particular NewGRF.
  * @param config     The configuration of the to be loaded NewGRF.
@@ -9645,10 +10245,18 @@ void LoadNewGRFFile(GRFConfig *config, uint file_index, GrfLoadingStage stage, S
 		return;
 	}
 
+	auto index_iter = _grf_sprite_indices.find(config);
+	const GRFSpriteIndex *index = index_iter != _grf_sprite_indices.end() ? index_iter->second.get() : nullptr;
+
 	if (stage == GLS_INIT || stage == GLS_ACTIVATION) {
 		/* We need the sprite offsets in the init stage for NewGRF sounds
 		 * and in the activation stage for real sprites. */
-		ReadGRFSpriteOffsets(_cur.grf_container_ver);
+		if (index != nullptr) {
+			if (_cur.grf_container_ver >= 2) FioReadDword();
+			SetGRFSpriteOffsets(index->sprite_offsets);
+		} else {
+			ReadGRFSpriteOffsets(_cur.grf_container_ver);
+		}
 	} else {
 		/* Skip sprite section offset if present. */
 		if (_cur.grf_container_ver >= 2) FioReadDword();
@@ -9678,19 +10286,47 @@ void LoadNewGRFFile(GRFConfig *config, uint file_index, GrfLoadingStage stage, S
 
 	ReusableBuffer<byte> buf;
 
-	while ((num = (_cur.grf_container_ver >= 2 ? FioReadDword() : FioReadWord())) != 0) {
-		byte type = FioReadByte();
+	/* With an index, only the handlers of pseudo sprites read from the file; 'pos' tracks the position of the next record. */
+	size_t pos = FioGetPos();
+	const GRFSpriteIndexEntry *entry = nullptr;
+
+	for (;;) {
+		byte type;
+		if (index != nullptr) {
+			entry = index->Find(pos, entry);
+			if (entry == nullptr) {
+				/* Not at a record boundary; continue reading the file. */
+				FioSeekTo(pos, SEEK_SET);
+				index = nullptr;
+				continue;
+			}
+			num = entry->num;
+			if (num == 0) break;
+			type = entry->type;
+			pos = entry->next_pos;
+		} else {
+			num = _cur.grf_container_ver >= 2 ? FioReadDword() : FioReadWord();
+			if (num == 0) break;
+			type = FioReadByte();
+		}
 		_cur.nfo_line++;
 
 		if (type == 0xFF) {
 			if (_cur.skip_sprites == 0) {
-				DecodeSpecialSprite(buf.Allocate(num), num, stage);
+				if (index != nullptr) {
+					/* Handlers may read following sprites or remember the position. */
+					FioSeekTo(pos, SEEK_SET);
+					DecodeSpecialSprite(buf.Allocate(num), num, stage, index->data.data() + entry->data);
+					pos = FioGetPos();
+				} else {
+					DecodeSpecialSprite(buf.Allocate(num), num, stage, nullptr);
+				}
 
 				/* Stop all processing if we are to skip the remaining sprites */
 				if (_cur.skip_sprites == -1) break;
 
 				continue;
-			} else {
+			} else if (index == nullptr) {
 				FioSkipBytes(num);
 			}
 		} else {
@@ -9700,7 +10336,9 @@ void LoadNewGRFFile(GRFConfig *config, uint file_index, GrfLoadingStage stage, S
 				break;
 			}
 
-			if (_cur.grf_container_ver >= 2 && type == 0xFD) {
+			if (index != nullptr) {
+				/* Already skipped using the index. */
+			} else if (_cur.grf_container_ver >= 2 && type == 0xFD) {
 				/* Reference to data section. Container version >= 2 only. */
 				FioSkipBytes(num);
 			} else {
@@ -10008,6 +10646,8 @@ void LoadNewGRF(uint load_index, uint file_index, uint num_baseset)
 
 	_cur.spriteid = load_index;
 
+	BuildGRFSpriteIndices(num_baseset);
+
 	/* Load newgrf sprites
 	 * in each loading stage, (try to) open each file specified in the config
 	 * and load information from it. */
@@ -10073,6 +10713,7 @@ void LoadNewGRF(uint load_index, uint file_index, uint num_baseset)
 
 	/* Pseudo sprite processing is finished; free temporary stuff */
 	_cur.ClearDataForNextFile();
+	_grf_sprite_indices.clear();
 
 	/* Call any functions that should be run after GRFs have been loaded. */
 	AfterLoadGRFs();
@@ -10085,6 +10726,9 @@ void LoadNewGRF(uint load_index, uint file_index, uint num_baseset)
 	_tick_skip_counter = tick_skip_counter;
 	_display_opt  = display_opt;
 	SetScaledTickVariables();
+
+	/* Results cached while loading may depend on GRF parameters which were changed afterwards. */
+	InvalidateDeterministicSpriteGroupResultCache();
 }
 
 /**
@@ -207,6 +207,16 @@ struct Action5TypeRemapSet {
 	}
 };
 
+/** Minimum level of grf debugging at which the #GRFResultCacheStats are collected. */
+static const int GRF_RESULT_CACHE_STATS_DEBUG_LEVEL = 5;
+
+/** Statistics of the cache of deterministic sprite group results of a NewGRF, only collected with -d grf=5 or higher. */
+struct GRFResultCacheStats {
+	uint64 hits;     ///< Number of chain evaluations answered from the cache.
+	uint64 misses;   ///< Number of cacheable chains which had to be evaluated.
+	uint64 uncached; ///< Number of chains which are not cached, because of their inputs or because they are cheap to evaluate.
+};
+
 /** Dynamic data of a loaded NewGRF */
 struct GRFFile : ZeroedMemoryAllocator {
 	char *filename;
@@ -252,6 +262,8 @@ struct GRFFile : ZeroedMemoryAllocator {
 	uint32 var8D_overlay;                    ///< Overlay for global variable 8D (action 0x14)
 	uint32 var9D_overlay;                    ///< Overlay for global variable 9D (action 0x14)
 
+	mutable GRFResultCacheStats result_cache_stats; ///< Statistics of the deterministic sprite group result cache.
+
 	GRFFile(const struct GRFConfig *config);
 	~GRFFile();
 
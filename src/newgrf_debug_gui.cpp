@@ -14,6 +14,7 @@
 #include <functional>
 #include "window_gui.h"
 #include "window_func.h"
+#include "debug.h"
 #include "fileio_func.h"
 #include "spritecache.h"
 #include "string_func.h"
@@ -487,6 +488,14 @@ struct NewGRFInspectWindow : Window {
 				this->DrawString(r, i++, "  Name: %s", grfconfig->GetName());
 				this->DrawString(r, i++, "  File: %s", grfconfig->filename);
 			}
+			extern GRFFile *GetFileByGRFID(uint32 grfid);
+			const GRFFile *grffile = GetFileByGRFID(grfid);
+			if (grffile != nullptr && _debug_grf_level >= GRF_RESULT_CACHE_STATS_DEBUG_LEVEL) {
+				const GRFResultCacheStats &stats = grffile->result_cache_stats;
+				uint64 cacheable = stats.hits + stats.misses;
+				this->DrawString(r, i++, "  Result cache: " OTTD_PRINTF64U " hits, " OTTD_PRINTF64U " misses (%u%% hit rate), " OTTD_PRINTF64U " not cached",
+						stats.hits, stats.misses, cacheable > 0 ? (uint)(stats.hits * 100 / cacheable) : 0, stats.uncached);
+			}
 		}
 
 		const_cast<NewGRFInspectWindow*>(this)->first_variable_line_index = i;
@@ -11,7 +11,10 @@
 
 #include "stdafx.h"
 #include <algorithm>
+#include <unordered_map>
 #include "debug.h"
+#include "newgrf.h"
+#include "date_func.h"
 #include "newgrf_spritegroup.h"
 #include "core/pool_func.hpp"
 #include "vehicle_type.h"
@@ -53,6 +56,7 @@ DeterministicSpriteGroup::~DeterministicSpriteGroup()
 {
 	free(this->adjusts);
 	free(this->ranges);
+	free(this->jump_table);
 }
 
 RandomizedSpriteGroup::~RandomizedSpriteGroup()
@@ -190,20 +194,340 @@ static U EvalAdjustT(const DeterministicSpriteGroupAdjust *adjust, ScopeResolver
 bool _sprite_group_resolve_check_veh_check = false;
 VehicleType _sprite_group_resolve_check_veh_type;
 
+/** Current generation of the result cache of deterministic sprite groups, cached results of other generations are invalid. */
+static uint32 _dsg_result_cache_generation = 1;
+
+/** Key into the result cache of deterministic sprite groups which read the callback information. */
+struct DSGCallbackResultCacheKey {
+	const DeterministicSpriteGroup *group; ///< Group the result belongs to.
+	CallbackID callback;                   ///< Callback being resolved.
+	uint32 param1;                         ///< First parameter (var 10) of the callback.
+	uint32 param2;                         ///< Second parameter (var 18) of the callback.
+
+	bool operator==(const DSGCallbackResultCacheKey &other) const
+	{
+		return this->group == other.group && this->callback == other.callback && this->param1 == other.param1 && this->param2 == other.param2;
+	}
+};
+
+/** Hash function for DSGCallbackResultCacheKey. */
+struct DSGCallbackResultCacheKeyHash {
+	size_t operator()(const DSGCallbackResultCacheKey &key) const
+	{
+		size_t hash = std::hash<const void *>()(key.group);
+		hash = hash * 31 + key.callback;
+		hash = hash * 31 + key.param1;
+		hash = hash * 31 + key.param2;
+		return hash;
+	}
+};
+
+/** Maximum number of entries in #_dsg_callback_result_cache before it is cleared. */
+static const size_t DSG_CALLBACK_RESULT_CACHE_MAX_ENTRIES = 1 << 16;
+
+/**
+ * Minimum number of adjusts of a chain which reads the callback information before its result is cached.
+ * Shorter chains, e.g. a plain switch on the callback ID, are cheaper to evaluate than to look up.
+ */
+static const uint DSG_CALLBACK_RESULT_CACHE_MIN_ADJUSTS = 4;
+
+/** Result cache of deterministic sprite groups which read the callback information. */
+static std::unordered_map<DSGCallbackResultCacheKey, DeterministicSpriteGroupResultCache, DSGCallbackResultCacheKeyHash> _dsg_callback_result_cache;
+
+/**
+ * Invalidate all cached results of deterministic sprite groups.
+ * This must be called whenever the inputs classified as static may have changed, i.e. when NewGRFs are (re)loaded.
+ */
+void InvalidateDeterministicSpriteGroupResultCache()
+{
+	_dsg_result_cache_generation++;
+	_dsg_callback_result_cache.clear();
+}
+
+/**
+ * Get the class of the input read by a variable of a variable chain.
+ * @param variable The variable.
+ * @return The input class of the variable.
+ */
+static DeterministicSpriteGroupInputClass GetVariableInputClass(byte variable)
+{
+	switch (variable) {
+		case 0x03: // climate
+		case 0x0B: // TTDPatch version
+		case 0x0C: // callback ID
+		case 0x0D: // TTD version
+		case 0x10: // callback parameter 1
+		case 0x18: // callback parameter 2
+		case 0x1A: // always -1
+		case 0x1D: // TTD platform
+		case 0x21: // OpenTTD version
+		case 0x7F: // GRF parameter
+			return DSGIC_STATIC;
+
+		case 0x00: // current date
+		case 0x01: // current year
+		case 0x02: // detailed date information
+		case 0x23: // long format date
+		case 0x24: // long format year
+			return DSGIC_DATE;
+
+		case 0x5F: // random bits and triggers
+			return DSGIC_RANDOM;
+
+		default:
+			return DSGIC_MAP;
+	}
+}
+
+/** Maximum number of entries of the jump table of a deterministic sprite group. */
+static const uint DSG_JUMP_TABLE_MAX_SIZE = 256;
+/** Maximum number of jump table entries per range, so jump tables are only used for dense ranges. */
+static const uint DSG_JUMP_TABLE_MAX_ENTRIES_PER_RANGE = 16;
+/** Maximum number of nested groups followed when evaluating a procedure call while loading. */
+static const uint DSG_CONSTANT_PROCEDURE_MAX_DEPTH = 8;
+
+/**
+ * Check whether an adjust reads a constant (variable 1A) and has no side effects.
+ * @param adjust The adjust.
+ * @return True if the value of the adjust is known while loading.
+ */
+static inline bool IsConstantAdjust(const DeterministicSpriteGroupAdjust &adjust)
+{
+	return adjust.variable == 0x1A && adjust.type == DSGA_TYPE_NONE && adjust.operation != DSGA_OP_STO && adjust.operation != DSGA_OP_STOP;
+}
+
+/**
+ * Evaluate an adjust reading a constant.
+ * @param size Size of the variable chain.
+ * @param adjust The adjust, see #IsConstantAdjust.
+ * @param last_value Result of the preceding adjusts.
+ * @return Result after the adjust.
+ */
+static uint32 EvalConstantAdjust(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust, uint32 last_value)
+{
+	switch (size) {
+		case DSG_SIZE_BYTE:  return EvalAdjustT<uint8,  int8> (&adjust, nullptr, last_value, UINT_MAX);
+		case DSG_SIZE_WORD:  return EvalAdjustT<uint16, int16>(&adjust, nullptr, last_value, UINT_MAX);
+		case DSG_SIZE_DWORD: return EvalAdjustT<uint32, int32>(&adjust, nullptr, last_value, UINT_MAX);
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Turn an adjust into one that reads a constant.
+ * @param adjust The adjust to change.
+ * @param operation Operation to apply the constant with.
+ * @param value The constant.
+ */
+static void SetConstantAdjust(DeterministicSpriteGroupAdjust &adjust, DeterministicSpriteGroupAdjustOperation operation, uint32 value)
+{
+	adjust.operation  = operation;
+	adjust.type       = DSGA_TYPE_NONE;
+	adjust.variable   = 0x1A;
+	adjust.parameter  = 0;
+	adjust.shift_num  = 0;
+	adjust.and_mask   = value;
+	adjust.add_val    = 0;
+	adjust.divmod_val = 0;
+	adjust.subroutine = nullptr;
+}
+
+/**
+ * Check whether an adjust only computes a value, which is always available.
+ * Such an adjust can be removed if its result is discarded.
+ * @param adjust The adjust.
+ * @return True if the adjust has no side effects.
+ */
+static bool IsSideEffectFreeAdjust(const DeterministicSpriteGroupAdjust &adjust)
+{
+	if (adjust.operation == DSGA_OP_STO || adjust.operation == DSGA_OP_STOP) return false;
+
+	switch (adjust.variable) {
+		case 0x00: case 0x01: case 0x02: case 0x03: case 0x06: case 0x09: case 0x0A: case 0x0B:
+		case 0x0C: case 0x0D: case 0x0E: case 0x0F: case 0x10: case 0x11: case 0x12: case 0x18:
+		case 0x1A: case 0x1B: case 0x1C: case 0x1D: case 0x1E: case 0x20: case 0x21: case 0x22:
+		case 0x23: case 0x24: case 0x5F: case 0x7D: case 0x7F:
+			return true;
+
+		default:
+			/* Object specific variables may be unavailable, procedure calls may have side effects. */
+			return false;
+	}
+}
+
+/**
+ * Try to determine the result of a procedure call (variable 7E) while loading.
+ * @param group The group called as procedure.
+ * @param[out] result The callback result of the procedure.
+ * @param[out] sets_last_value Set to true if resolving the procedure changes the last value (variable 1C).
+ * @param depth Number of groups followed so far.
+ * @return True if the result does not depend on anything but the groups themselves.
+ */
+static bool GetConstantProcedureResult(const SpriteGroup *group, uint32 &result, bool &sets_last_value, uint depth = 0)
+{
+	if (group == nullptr) {
+		result = CALLBACK_FAILED;
+		return true;
+	}
+
+	switch (group->type) {
+		case SGT_CALLBACK:
+			result = group->GetCallbackResult();
+			return true;
+
+		case SGT_DETERMINISTIC: {
+			const DeterministicSpriteGroup *dsg = (const DeterministicSpriteGroup *)group;
+			if (depth >= DSG_CONSTANT_PROCEDURE_MAX_DEPTH) return false;
+			if (dsg->num_adjusts != 1 || !IsConstantAdjust(dsg->adjusts[0])) return false;
+
+			uint32 value = EvalConstantAdjust(dsg->size, dsg->adjusts[0], 0);
+			sets_last_value = true;
+			if (dsg->calculated_result) {
+				result = (value != CALLBACK_FAILED) ? GB(value, 0, 15) : CALLBACK_FAILED;
+				return true;
+			}
+			return GetConstantProcedureResult(dsg->SelectRangeGroup(value), result, sets_last_value, depth + 1);
+		}
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Simplify the group after loading it.
+ * - Procedure calls with a result known while loading are replaced by constants.
+ * - Adjusts whose result is discarded by a later RST are removed.
+ * - Runs of constant adjusts are folded into a single constant.
+ * - Dense ranges are turned into a jump table.
+ * The result of resolving the group does not change.
+ */
+void DeterministicSpriteGroup::Optimise()
+{
+	std::vector<DeterministicSpriteGroupAdjust> adjusts(this->adjusts, this->adjusts + this->num_adjusts);
+
+	/* Inline procedure calls with a known result. The procedure may also set the last value,
+	 * which is only allowed if no later adjust of this chain can observe it. */
+	for (size_t i = 0; i < adjusts.size(); i++) {
+		DeterministicSpriteGroupAdjust &adjust = adjusts[i];
+		if (adjust.variable != 0x7E || adjust.operation == DSGA_OP_STO || adjust.operation == DSGA_OP_STOP) continue;
+
+		uint32 result;
+		bool sets_last_value = false;
+		if (!GetConstantProcedureResult(adjust.subroutine, result, sets_last_value)) continue;
+		if (sets_last_value) {
+			bool observed = false;
+			for (size_t j = i + 1; j < adjusts.size(); j++) {
+				byte var = adjusts[j].variable;
+				if (var == 0x1C || var == 0x7B || var == 0x7E) observed = true;
+			}
+			if (observed) continue;
+		}
+
+		adjust.variable = 0x1A;
+		adjust.and_mask = (result >> adjust.shift_num) & adjust.and_mask;
+		adjust.shift_num = 0;
+		adjust.subroutine = nullptr;
+	}
+
+	/* Everything before the last RST only matters for its side effects,
+	 * unless the RST reads variable 7B, whose parameter is the preceding value. */
+	size_t last_rst = 0;
+	for (size_t i = 1; i < adjusts.size(); i++) {
+		if (adjusts[i].operation == DSGA_OP_RST) last_rst = i;
+	}
+	if (adjusts[last_rst].variable != 0x7B) {
+		size_t first_dead = last_rst;
+		while (first_dead > 0 && IsSideEffectFreeAdjust(adjusts[first_dead - 1])) first_dead--;
+		adjusts.erase(adjusts.begin() + first_dead, adjusts.begin() + last_rst);
+	}
+
+	/* Fold runs of constants which start with a known value. */
+	std::vector<DeterministicSpriteGroupAdjust> folded;
+	for (size_t i = 0; i < adjusts.size();) {
+		const DeterministicSpriteGroupAdjust &adjust = adjusts[i];
+		if ((folded.empty() || adjust.operation == DSGA_OP_RST) && IsConstantAdjust(adjust)) {
+			uint32 value = EvalConstantAdjust(this->size, adjust, 0);
+			size_t j = i + 1;
+			for (; j < adjusts.size() && IsConstantAdjust(adjusts[j]); j++) {
+				value = EvalConstantAdjust(this->size, adjusts[j], value);
+			}
+			folded.push_back(adjust);
+			if (j - i > 1) SetConstantAdjust(folded.back(), folded.size() == 1 ? DSGA_OP_ADD : DSGA_OP_RST, value);
+			i = j;
+		} else {
+			folded.push_back(adjust);
+			i++;
+		}
+	}
+
+	assert(folded.size() > 0 && folded.size() <= this->num_adjusts);
+	this->num_adjusts = (uint)folded.size();
+	MemCpyT(this->adjusts, folded.data(), this->num_adjusts);
+
+	/* Build a jump table for dense ranges. */
+	free(this->jump_table);
+	this->jump_table = nullptr;
+	if (this->num_ranges > 4) {
+		uint64 span = (uint64)this->ranges[this->num_ranges - 1].high - this->ranges[0].low + 1;
+		if (span <= DSG_JUMP_TABLE_MAX_SIZE && span <= (uint64)this->num_ranges * DSG_JUMP_TABLE_MAX_ENTRIES_PER_RANGE) {
+			const SpriteGroup **table = MallocT<const SpriteGroup *>((size_t)span);
+			for (uint i = 0; i < span; i++) table[i] = this->default_group;
+			for (uint i = 0; i < this->num_ranges; i++) {
+				for (uint64 v = this->ranges[i].low; v <= this->ranges[i].high; v++) table[v - this->ranges[0].low] = this->ranges[i].group;
+			}
+			this->jump_table_base = this->ranges[0].low;
+			this->jump_table_size = (uint)span;
+			this->jump_table = table;
+		}
+	}
+}
+
+/**
+ * Determine which classes of inputs the variable chain reads, and so whether its result is cached.
+ * Only chains reading static or date-dependent inputs are cached, and only when evaluating them costs more than the lookup.
+ * Must be called whenever the adjusts of the group are changed.
+ */
+void DeterministicSpriteGroup::ClassifyInputs()
+{
+	this->input_class = DSGIC_STATIC;
+	this->reads_callback_info = false;
+	this->clears_veh_check = false;
+	this->result_cache.generation = 0;
+
+	for (uint i = 0; i < this->num_adjusts; i++) {
+		const DeterministicSpriteGroupAdjust &adjust = this->adjusts[i];
+
+		DeterministicSpriteGroupInputClass input_class = GetVariableInputClass(adjust.variable);
+		/* Storing values has side effects, which must not be skipped. */
+		if (adjust.operation == DSGA_OP_STO || adjust.operation == DSGA_OP_STOP) input_class = DSGIC_MAP;
+		this->input_class = max(this->input_class, input_class);
+
+		if (adjust.variable == 0x0C || adjust.variable == 0x10 || adjust.variable == 0x18) this->reads_callback_info = true;
+		if (adjust.variable != 0x0C && adjust.variable != 0x1A && adjust.variable != 0x7F) this->clears_veh_check = true;
+	}
+
+	this->use_result_cache = this->input_class <= DSGIC_DATE && this->num_adjusts >= (this->reads_callback_info ? DSG_CALLBACK_RESULT_CACHE_MIN_ADJUSTS : 2);
+}
+
 static bool RangeHighComparator(const DeterministicSpriteGroupRange& range, uint32 value)
 {
 	return range.high < value;
 }
 
-const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) const
+/**
+ * Evaluate the variable chain of the group.
+ * @param object The resolver object.
+ * @param scope The scope to read the variables of.
+ * @param[out] value The result of the chain.
+ * @return False if the chain read a variable which is not available.
+ */
+bool DeterministicSpriteGroup::EvaluateAdjusts(ResolverObject &object, ScopeResolver *scope, uint32 &value) const
 {
 	uint32 last_value = 0;
-	uint32 value = 0;
-	uint i;
-
-	ScopeResolver *scope = object.GetScope(this->var_scope);
+	value = 0;
 
-	for (i = 0; i < this->num_adjusts; i++) {
+	for (uint i = 0; i < this->num_adjusts; i++) {
 		DeterministicSpriteGroupAdjust *adjust = &this->adjusts[i];
 
 		/* Try to get the variable. We shall assume it is available, unless told otherwise. */
@@ -272,11 +596,7 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 			value = GetVariable(object, scope, adjust->variable, adjust->parameter, &available);
 		}
 
-		if (!available) {
-			/* Unsupported variable: skip further processing and return either
-			 * the group from the first range or the default group. */
-			return SpriteGroup::Resolve(this->error_group, object, false);
-		}
+		if (!available) return false;
 
 		switch (this->size) {
 			case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value); break;
@@ -287,7 +607,52 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 		last_value = value;
 	}
 
-	object.last_value = last_value;
+	return true;
+}
+
+const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) const
+{
+	uint32 value = 0;
+
+	ScopeResolver *scope = object.GetScope(this->var_scope);
+
+	bool collect_stats = _debug_grf_level >= GRF_RESULT_CACHE_STATS_DEBUG_LEVEL && object.grffile != nullptr;
+
+	if (this->use_result_cache) {
+		/* The chain only reads inputs which do not depend on the object, the result can be cached. */
+		DSGCallbackResultCacheKey key = { this, object.callback, object.callback_param1, object.callback_param2 };
+		const DeterministicSpriteGroupResultCache *cache = &this->result_cache;
+		if (this->reads_callback_info) {
+			auto iter = _dsg_callback_result_cache.find(key);
+			cache = (iter != _dsg_callback_result_cache.end()) ? &iter->second : nullptr;
+		}
+
+		if (cache != nullptr && cache->generation == _dsg_result_cache_generation && (this->input_class == DSGIC_STATIC || cache->date == _date)) {
+			if (collect_stats) object.grffile->result_cache_stats.hits++;
+			if (this->clears_veh_check) _sprite_group_resolve_check_veh_check = false;
+			value = cache->value;
+		} else {
+			if (collect_stats) object.grffile->result_cache_stats.misses++;
+			if (!this->EvaluateAdjusts(object, scope, value)) return SpriteGroup::Resolve(this->error_group, object, false);
+
+			DeterministicSpriteGroupResultCache entry = { value, _dsg_result_cache_generation, _date };
+			if (this->reads_callback_info) {
+				if (_dsg_callback_result_cache.size() >= DSG_CALLBACK_RESULT_CACHE_MAX_ENTRIES) _dsg_callback_result_cache.clear();
+				_dsg_callback_result_cache[key] = entry;
+			} else {
+				this->result_cache = entry;
+			}
+		}
+	} else {
+		if (collect_stats) object.grffile->result_cache_stats.uncached++;
+		if (!this->EvaluateAdjusts(object, scope, value)) {
+			/* Unsupported variable: skip further processing and return either
+			 * the group from the first range or the default group. */
+			return SpriteGroup::Resolve(this->error_group, object, false);
+		}
+	}
+
+	object.last_value = value;
 
 	if (this->calculated_result) {
 		/* nvar == 0 is a special case -- we turn our value into a callback result */
@@ -297,21 +662,36 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 		return &nvarzero;
 	}
 
+	return SpriteGroup::Resolve(this->SelectRangeGroup(value), object, false);
+}
+
+/**
+ * Get the group of the range containing a value.
+ * @param value Result of the variable chain.
+ * @return The group of the range, or the default group if no range contains \a value.
+ */
+const SpriteGroup *DeterministicSpriteGroup::SelectRangeGroup(uint32 value) const
+{
+	if (this->jump_table != nullptr) {
+		uint32 index = value - this->jump_table_base;
+		return index < this->jump_table_size ? this->jump_table[index] : this->default_group;
+	}
+
 	if (this->num_ranges > 4) {
 		DeterministicSpriteGroupRange *lower = std::lower_bound(this->ranges + 0, this->ranges + this->num_ranges, value, RangeHighComparator);
 		if (lower != this->ranges + this->num_ranges && lower->low <= value) {
 			assert(lower->low <= value && value <= lower->high);
-			return SpriteGroup::Resolve(lower->group, object, false);
+			return lower->group;
 		}
 	} else {
-		for (i = 0; i < this->num_ranges; i++) {
+		for (uint i = 0; i < this->num_ranges; i++) {
 			if (this->ranges[i].low <= value && value <= this->ranges[i].high) {
-				return SpriteGroup::Resolve(this->ranges[i].group, object, false);
+				return this->ranges[i].group;
 			}
 		}
 	}
 
-	return SpriteGroup::Resolve(this->default_group, object, false);
+	return this->default_group;
 }
 
 
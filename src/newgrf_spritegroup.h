@@ -16,6 +16,7 @@
 #include "engine_type.h"
 #include "house_type.h"
 #include "industry_type.h"
+#include "date_type.h"
 
 #include "newgrf_callbacks.h"
 #include "newgrf_generic.h"
@@ -48,6 +49,7 @@ enum SpriteGroupType {
 struct SpriteGroup;
 typedef uint32 SpriteGroupID;
 struct ResolverObject;
+struct ScopeResolver;
 
 /* SPRITE_WIDTH is 24. ECS has roughly 30 sprite groups per real sprite.
  * Adding an 'extra' margin would be assuming 64 sprite groups per real
@@ -168,6 +170,21 @@ struct DeterministicSpriteGroupRange {
 };
 
 
+/** Classes of inputs read by the variable chain of a deterministic sprite group, in increasing order of volatility. */
+enum DeterministicSpriteGroupInputClass {
+	DSGIC_STATIC,      ///< Only values which do not change while the NewGRFs are loaded, e.g. the climate or GRF parameters.
+	DSGIC_DATE,        ///< Also the current date, the result is valid for one day.
+	DSGIC_RANDOM,      ///< Random bits, triggers or the result of randomised groups.
+	DSGIC_MAP,         ///< State of the object or the map around it, registers or procedure calls. Also used for chains with side effects.
+};
+
+/** Cache of the result of the variable chain of a deterministic sprite group which does not read the callback information. */
+struct DeterministicSpriteGroupResultCache {
+	uint32 value;      ///< Result of the variable chain.
+	uint32 generation; ///< Generation of the cache when \a value was computed, 0 if never.
+	Date date;         ///< Date when \a value was computed, only checked for #DSGIC_DATE.
+};
+
 struct DeterministicSpriteGroup : SpriteGroup {
 	DeterministicSpriteGroup() : SpriteGroup(SGT_DETERMINISTIC) {}
 	~DeterministicSpriteGroup();
@@ -185,10 +202,29 @@ struct DeterministicSpriteGroup : SpriteGroup {
 
 	const SpriteGroup *error_group; // was first range, before sorting ranges
 
+	const SpriteGroup **jump_table; ///< Dense lookup of the ranges (dynamically allocated), indexed by the value minus \a jump_table_base, or nullptr if the ranges are not dense.
+	uint32 jump_table_base;         ///< Value of the first entry of \a jump_table.
+	uint jump_table_size;           ///< Number of entries of \a jump_table.
+
+	DeterministicSpriteGroupInputClass input_class; ///< Most volatile class of input read by the variable chain.
+	bool use_result_cache;                          ///< Whether the result of the variable chain is cached, see #ClassifyInputs.
+	bool reads_callback_info;                       ///< Whether the variable chain reads the callback ID or parameters (variables 0C, 10 and 18).
+	bool clears_veh_check;                          ///< Whether the variable chain reads a variable which is not on the vehicle re-check whitelist.
+	mutable DeterministicSpriteGroupResultCache result_cache; ///< Cached result, if the chain does not read the callback information.
+
+	void Optimise();
+	void ClassifyInputs();
+	const SpriteGroup *SelectRangeGroup(uint32 value) const;
+
 protected:
 	const SpriteGroup *Resolve(ResolverObject &object) const;
+
+private:
+	bool EvaluateAdjusts(ResolverObject &object, ScopeResolver *scope, uint32 &value) const;
 };
 
+void InvalidateDeterministicSpriteGroupResultCache();
+
 enum RandomizedSpriteGroupCompareMode {
 	RSG_CMP_ANY,
 	RSG_CMP_ALL,
@@ -1332,6 +1332,7 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 		old_station_industries_nears.push_back(st->industries_near);
 		old_station_catchment_tiles.push_back(st->catchment_tiles);
 	}
+	const StationCatchmentIndex old_station_catchment_index = _station_catchment_index;
 
 	std::vector<StationList> old_industry_stations_nears;
 	Industry *ind;
@@ -1374,8 +1375,17 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 		if (!(old_station_catchment_tiles[i] == st->catchment_tiles)) {
 			CCLOG("station stations_near mismatch: st %i", (int)st->index);
 		}
+		for (CargoID c = 0; c < NUM_CARGO; c++) {
+			const GoodsEntry &ge = st->goods[c];
+			if ((ge.HasRating() || ge.rating < INITIAL_STATION_RATING) && !HasBit(st->rating_cargoes, c)) {
+				CCLOG("station rating_cargoes mismatch: st %i, cargo %i", (int)st->index, (int)c);
+			}
+		}
 		i++;
 	}
+	if (old_station_catchment_index != _station_catchment_index) {
+		CCLOG("station catchment index mismatch");
+	}
 	i = 0;
 	FOR_ALL_INDUSTRIES(ind) {
 		if (old_industry_stations_nears[i] != ind->stations_near) {
@@ -1570,6 +1580,13 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 		free(veh_old);
 	}
 
+	/* Check that the pending cargo aging gives the same result as aging the packets step by step */
+	FOR_ALL_VEHICLES(v) {
+		if (!v->cargo.CheckPendingAging()) {
+			CCLOG("cargo aging mismatch: type %i, vehicle %i, company %i, unit number %i", (int)v->type, v->index, (int)v->owner, v->unitnumber);
+		}
+	}
+
 	/* Check whether the caches are still valid */
 	FOR_ALL_VEHICLES(v) {
 		byte buff[sizeof(VehicleCargoList)];
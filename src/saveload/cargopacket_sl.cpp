@@ -12,14 +12,11 @@
 #include "../stdafx.h"
 #include "../vehicle_base.h"
 #include "../station_base.h"
-#include "../3rdparty/cpp-btree/btree_map.h"
 
 #include "saveload.h"
 
 #include "../safeguards.h"
 
-extern btree::btree_map<uint64, Money> _cargo_packet_deferred_payments;
-
 /**
  * Savegame conversion for cargopackets.
  */
@@ -119,8 +116,11 @@ const SaveLoad *GetCargoPacketDesc()
  */
 static void Save_CAPA()
 {
-	CargoPacket *cp;
+	/* Bring the packets of vehicles up to date with their aging first. */
+	Vehicle *v;
+	FOR_ALL_VEHICLES(v) v->cargo.ApplyPendingAging();
 
+	CargoPacket *cp;
 	FOR_ALL_CARGOPACKETS(cp) {
 		SlSetArrayIndex(cp->index);
 		SlObject(cp, GetCargoPacketDesc());
@@ -145,11 +145,15 @@ static void Load_CAPA()
  */
 void Save_CPDP()
 {
-	SlSetLength(16 * _cargo_packet_deferred_payments.size());
+	SlSetLength(16 * _cargo_packet_deferred_payment_count);
 
-	for (auto &it : _cargo_packet_deferred_payments) {
-		SlWriteUint64(it.first);
-		SlWriteUint64(it.second);
+	/* Keys are ordered by packet, company and vehicle type. */
+	const CargoPacket *cp;
+	FOR_ALL_CARGOPACKETS(cp) {
+		cp->IterateDeferredPayments([&](Money payment, CompanyID cid, VehicleType type) {
+			SlWriteUint64((((uint64) cp->index) << 32) | (cid << 24) | (type << 22));
+			SlWriteUint64(payment);
+		});
 	}
 }
 
@@ -159,16 +163,11 @@ void Save_CPDP()
 void Load_CPDP()
 {
 	uint count = SlGetFieldLength() / 16;
-	uint last_cargo_packet_id = (uint) -1;
 
 	for (uint i = 0; i < count; i++) {
 		uint64 k = SlReadUint64();
 		uint64 v = SlReadUint64();
-		_cargo_packet_deferred_payments[k] = v;
-		if (k >> 32 != last_cargo_packet_id) {
-			last_cargo_packet_id = k >> 32;
-			CargoPacket::Get(last_cargo_packet_id)->flags |= CargoPacket::CPF_HAS_DEFERRED_PAYMENT;
-		}
+		CargoPacket::Get(k >> 32)->RegisterDeferredCargoPayment((CompanyID) GB(k, 24, 8), (VehicleType) GB(k, 22, 2), v);
 	}
 }
 
@@ -144,19 +144,23 @@ static const SaveLoad _edge_desc[] = {
  */
 void SaveLoad_LinkGraph(LinkGraph &lg)
 {
+	/* Access the edges through the const accessor, which doesn't copy rows
+	 * shared with a running job. When loading the rows aren't shared yet. */
+	const LinkGraph::EdgeMatrix &edges = lg.edges;
 	uint size = lg.Size();
 	for (NodeID from = 0; from < size; ++from) {
 		Node *node = &lg.nodes[from];
 		SlObject(node, _node_desc);
+		Edge *row = const_cast<Edge *>(edges[from]);
 		if (IsSavegameVersionBefore(SLV_191)) {
 			/* We used to save the full matrix ... */
 			for (NodeID to = 0; to < size; ++to) {
-				SlObject(&lg.edges[from][to], _edge_desc);
+				SlObject(&row[to], _edge_desc);
 			}
 		} else {
 			/* ... but as that wasted a lot of space we save a sparse matrix now. */
-			for (NodeID to = from; to != INVALID_NODE; to = lg.edges[from][to].next_edge) {
-				SlObject(&lg.edges[from][to], _edge_desc);
+			for (NodeID to = from; to != INVALID_NODE; to = row[to].next_edge) {
+				SlObject(&row[to], _edge_desc);
 			}
 		}
 	}
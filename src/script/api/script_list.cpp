@@ -14,416 +14,202 @@
 #include "script_controller.hpp"
 #include "../../debug.h"
 #include "../../script/squirrel.hpp"
+#include <algorithm>
 
 #include "../../safeguards.h"
 
 /**
- * Base class for any ScriptList sorter.
+ * Hash an item for the index of a ScriptList.
+ * @param item The item to hash.
+ * @return The hash of the item.
  */
-class ScriptListSorter {
-protected:
-	ScriptList *list;       ///< The list that's being sorted.
-	bool has_no_more_items; ///< Whether we have more items to iterate over.
-	int64 item_next;        ///< The next item we will show.
-
-public:
-	/**
-	 * Virtual dtor, needed to mute warnings.
-	 */
-	virtual ~ScriptListSorter() { }
-
-	/**
-	 * Get the first item of the sorter.
-	 */
-	virtual int64 Begin() = 0;
-
-	/**
-	 * Stop iterating a sorter.
-	 */
-	virtual void End() = 0;
-
-	/**
-	 * Get the next item of the sorter.
-	 */
-	virtual int64 Next() = 0;
-
-	/**
-	 * See if the sorter has reached the end.
-	 */
-	bool IsEnd()
-	{
-		return this->list->buckets.empty() || this->has_no_more_items;
-	}
-
-	/**
-	 * Callback from the list if an item gets removed.
-	 */
-	virtual void Remove(int item) = 0;
-
-	/**
-	 * Attach the sorter to a new list. This assumes the content of the old list has been moved to
-	 * the new list, too, so that we don't have to invalidate any iterators. Note that std::swap
-	 * doesn't invalidate iterators on lists and maps, so that should be safe.
-	 * @param target New list to attach to.
-	 */
-	virtual void Retarget(ScriptList *new_list)
-	{
-		this->list = new_list;
-	}
-};
+static inline size_t ScriptListHash(int64 item)
+{
+	uint64 x = (uint64)item;
+	x ^= x >> 33;
+	x *= 0xFF51AFD7ED558CCDULL;
+	x ^= x >> 33;
+	return (size_t)x;
+}
 
 /**
- * Sort by value, ascending.
+ * Sort a range, or only partition it around \a nth when that is not \a last.
+ * @param first Begin of the range.
+ * @param nth Element to partition around.
+ * @param last End of the range.
+ * @param comparator The ordering.
  */
-class ScriptListSorterValueAscending : public ScriptListSorter {
-private:
-	ScriptList::ScriptListBucket::iterator bucket_iter;    ///< The iterator over the list to find the buckets.
-	ScriptList::ScriptItemList *bucket_list;               ///< The current bucket list we're iterator over.
-	ScriptList::ScriptItemList::iterator bucket_list_iter; ///< The iterator over the bucket list.
-
-public:
-	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
-	 */
-	ScriptListSorterValueAscending(ScriptList *list)
-	{
-		this->list = list;
-		this->End();
-	}
-
-	int64 Begin()
-	{
-		if (this->list->buckets.empty()) return 0;
-		this->has_no_more_items = false;
-
-		this->bucket_iter = this->list->buckets.begin();
-		this->bucket_list = &(*this->bucket_iter).second;
-		this->bucket_list_iter = this->bucket_list->begin();
-		this->item_next = *this->bucket_list_iter;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
-
-	void End()
-	{
-		this->bucket_list = nullptr;
-		this->has_no_more_items = true;
-		this->item_next = 0;
-	}
-
-	/**
-	 * Find the next item, and store that information.
-	 */
-	void FindNext()
-	{
-		if (this->bucket_list == nullptr) {
-			this->has_no_more_items = true;
-			return;
-		}
-
-		this->bucket_list_iter++;
-		if (this->bucket_list_iter == this->bucket_list->end()) {
-			this->bucket_iter++;
-			if (this->bucket_iter == this->list->buckets.end()) {
-				this->bucket_list = nullptr;
-				return;
-			}
-			this->bucket_list = &(*this->bucket_iter).second;
-			this->bucket_list_iter = this->bucket_list->begin();
-		}
-		this->item_next = *this->bucket_list_iter;
-	}
-
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+template <typename Titer, typename Tcomparator>
+static void OrderRange(Titer first, Titer nth, Titer last, Tcomparator comparator)
+{
+	if (nth == last) {
+		std::sort(first, last, comparator);
+	} else {
+		std::nth_element(first, nth, last, comparator);
 	}
+}
 
-	void Remove(int item)
-	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
-	}
-};
+/** Sentinel returned by ScriptList::FindPosition when an item is not in the list. */
+static const size_t SCRIPT_LIST_NOT_FOUND = SIZE_MAX;
 
 /**
- * Sort by value, descending.
+ * Find the slot in the index holding the item, or the empty slot where it would go.
+ * @param item The item to look for.
+ * @return The slot.
+ * @pre !this->index.empty()
  */
-class ScriptListSorterValueDescending : public ScriptListSorter {
-private:
-	/* Note: We cannot use reverse_iterator.
-	 *       The iterators must only be invalidated when the element they are pointing to is removed.
-	 *       This only holds for forward iterators. */
-	ScriptList::ScriptListBucket::iterator bucket_iter;    ///< The iterator over the list to find the buckets.
-	ScriptList::ScriptItemList *bucket_list;               ///< The current bucket list we're iterator over.
-	ScriptList::ScriptItemList::iterator bucket_list_iter; ///< The iterator over the bucket list.
-
-public:
-	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
-	 */
-	ScriptListSorterValueDescending(ScriptList *list)
-	{
-		this->list = list;
-		this->End();
-	}
-
-	int64 Begin()
-	{
-		if (this->list->buckets.empty()) return 0;
-		this->has_no_more_items = false;
-
-		/* Go to the end of the bucket-list */
-		this->bucket_iter = this->list->buckets.end();
-		--this->bucket_iter;
-		this->bucket_list = &(*this->bucket_iter).second;
-
-		/* Go to the end of the items in the bucket */
-		this->bucket_list_iter = this->bucket_list->end();
-		--this->bucket_list_iter;
-		this->item_next = *this->bucket_list_iter;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
-
-	void End()
-	{
-		this->bucket_list = nullptr;
-		this->has_no_more_items = true;
-		this->item_next = 0;
-	}
-
-	/**
-	 * Find the next item, and store that information.
-	 */
-	void FindNext()
-	{
-		if (this->bucket_list == nullptr) {
-			this->has_no_more_items = true;
-			return;
-		}
-
-		if (this->bucket_list_iter == this->bucket_list->begin()) {
-			if (this->bucket_iter == this->list->buckets.begin()) {
-				this->bucket_list = nullptr;
-				return;
-			}
-			this->bucket_iter--;
-			this->bucket_list = &(*this->bucket_iter).second;
-			/* Go to the end of the items in the bucket */
-			this->bucket_list_iter = this->bucket_list->end();
-			--this->bucket_list_iter;
-		} else {
-			this->bucket_list_iter--;
-		}
-		this->item_next = *this->bucket_list_iter;
-	}
-
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
-
-	void Remove(int item)
-	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
+size_t ScriptList::FindSlot(int64 item) const
+{
+	size_t mask = this->index.size() - 1;
+	for (size_t slot = ScriptListHash(item) & mask;; slot = (slot + 1) & mask) {
+		uint32 pos = this->index[slot];
+		if (pos == 0 || this->items[pos - 1].item == item) return slot;
 	}
-};
+}
 
 /**
- * Sort by item, ascending.
+ * Find the position of an item in #items.
+ * @param item The item to look for.
+ * @return The position, or SCRIPT_LIST_NOT_FOUND.
  */
-class ScriptListSorterItemAscending : public ScriptListSorter {
-private:
-	ScriptList::ScriptListMap::iterator item_iter; ///< The iterator over the items in the map.
-
-public:
-	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
-	 */
-	ScriptListSorterItemAscending(ScriptList *list)
-	{
-		this->list = list;
-		this->End();
-	}
-
-	int64 Begin()
-	{
-		if (this->list->items.empty()) return 0;
-		this->has_no_more_items = false;
-
-		this->item_iter = this->list->items.begin();
-		this->item_next = (*this->item_iter).first;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
-
-	void End()
-	{
-		this->has_no_more_items = true;
-	}
-
-	/**
-	 * Find the next item, and store that information.
-	 */
-	void FindNext()
-	{
-		if (this->item_iter == this->list->items.end()) {
-			this->has_no_more_items = true;
-			return;
-		}
-		this->item_iter++;
-		if (this->item_iter != this->list->items.end()) item_next = (*this->item_iter).first;
-	}
-
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
+size_t ScriptList::FindPosition(int64 item) const
+{
+	if (this->items.empty()) return SCRIPT_LIST_NOT_FOUND;
+	uint32 pos = this->index[this->FindSlot(item)];
+	return pos == 0 ? SCRIPT_LIST_NOT_FOUND : pos - 1;
+}
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+/**
+ * Add the item at the given position of #items to the index, growing the index when it gets too full.
+ * @param pos The position of the item.
+ */
+void ScriptList::InsertIndex(size_t pos)
+{
+	if (this->items.size() * 2 > this->index.size()) {
+		this->RebuildIndex();
+		return;
 	}
+	this->index[this->FindSlot(this->items[pos].item)] = (uint32)(pos + 1);
+}
 
-	void Remove(int item)
-	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
+/**
+ * Remove a slot from the index. Entries following it in the probe
+ * sequence are shifted back, so no tombstones are needed.
+ * @param slot The slot to empty.
+ */
+void ScriptList::EraseIndex(size_t slot)
+{
+	size_t mask = this->index.size() - 1;
+	size_t hole = slot;
+	for (size_t next = (hole + 1) & mask; this->index[next] != 0; next = (next + 1) & mask) {
+		size_t home = ScriptListHash(this->items[this->index[next] - 1].item) & mask;
+		/* The entry may fill the hole when its home slot does not lie cyclically in (hole, next]. */
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			this->index[hole] = this->index[next];
+			hole = next;
 		}
 	}
-};
+	this->index[hole] = 0;
+}
 
 /**
- * Sort by item, descending.
+ * Rebuild the index from scratch, after #items has been reordered or compacted.
+ * The storage of the index is reused, so this does not allocate unless the list grew.
  */
-class ScriptListSorterItemDescending : public ScriptListSorter {
-private:
-	/* Note: We cannot use reverse_iterator.
-	 *       The iterators must only be invalidated when the element they are pointing to is removed.
-	 *       This only holds for forward iterators. */
-	ScriptList::ScriptListMap::iterator item_iter; ///< The iterator over the items in the map.
-
-public:
-	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
-	 */
-	ScriptListSorterItemDescending(ScriptList *list)
-	{
-		this->list = list;
-		this->End();
-	}
-
-	int64 Begin()
-	{
-		if (this->list->items.empty()) return 0;
-		this->has_no_more_items = false;
-
-		this->item_iter = this->list->items.end();
-		--this->item_iter;
-		this->item_next = (*this->item_iter).first;
+void ScriptList::RebuildIndex()
+{
+	size_t size = 16;
+	while (size < this->items.size() * 2) size *= 2;
+	this->index.assign(size, 0);
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+	size_t mask = size - 1;
+	for (size_t pos = 0; pos < this->items.size(); pos++) {
+		size_t slot = ScriptListHash(this->items[pos].item) & mask;
+		while (this->index[slot] != 0) slot = (slot + 1) & mask;
+		this->index[slot] = (uint32)(pos + 1);
 	}
+}
 
-	void End()
-	{
-		this->has_no_more_items = true;
-	}
+/**
+ * Make sure #items is sorted by item, ascending.
+ */
+void ScriptList::SortByItem()
+{
+	if (this->items_sorted) return;
+	OrderItems(this->items.begin(), this->items.end(), this->items.end(), SORT_BY_ITEM, true);
+	this->RebuildIndex();
+	this->items_sorted = true;
+}
 
-	/**
-	 * Find the next item, and store that information.
-	 */
-	void FindNext()
-	{
-		if (this->item_iter == this->list->items.end()) {
-			this->has_no_more_items = true;
-			return;
-		}
-		if (this->item_iter == this->list->items.begin()) {
-			/* Use 'end' as marker for 'beyond begin' */
-			this->item_iter = this->list->items.end();
-		} else {
-			this->item_iter--;
-		}
-		if (this->item_iter != this->list->items.end()) item_next = (*this->item_iter).first;
-	}
+/**
+ * Order a range of items according to a sorter. Ties in value are broken by
+ * the item, in the same direction, so the order is always fully defined.
+ * @param first Begin of the range.
+ * @param nth When not \a last, only partition the range around this element.
+ * @param last End of the range.
+ * @param sorter The sorter type.
+ * @param ascending Whether to sort ascending.
+ */
+/* static */ void ScriptList::OrderItems(std::vector<ScriptListItem>::iterator first, std::vector<ScriptListItem>::iterator nth, std::vector<ScriptListItem>::iterator last, SorterType sorter, bool ascending)
+{
+	switch (sorter) {
+		case SORT_BY_ITEM:
+			if (ascending) {
+				OrderRange(first, nth, last, [](const ScriptListItem &a, const ScriptListItem &b) { return a.item < b.item; });
+			} else {
+				OrderRange(first, nth, last, [](const ScriptListItem &a, const ScriptListItem &b) { return a.item > b.item; });
+			}
+			break;
 
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
+		case SORT_BY_VALUE:
+			if (ascending) {
+				OrderRange(first, nth, last, [](const ScriptListItem &a, const ScriptListItem &b) { return a.value != b.value ? a.value < b.value : a.item < b.item; });
+			} else {
+				OrderRange(first, nth, last, [](const ScriptListItem &a, const ScriptListItem &b) { return a.value != b.value ? a.value > b.value : a.item > b.item; });
+			}
+			break;
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+		default: NOT_REACHED();
 	}
+}
 
-	void Remove(int item)
-	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
-	}
-};
+/**
+ * Remove all items matching a predicate in a single pass over the list.
+ * The relative order of the remaining items is kept.
+ * @param predicate Function returning true for the items to remove.
+ */
+template <typename Tpredicate>
+void ScriptList::RemoveItemsIf(Tpredicate predicate)
+{
+	this->modifications++;
 
+	auto last = std::remove_if(this->items.begin(), this->items.end(), predicate);
+	if (last == this->items.end()) return;
 
+	this->items.erase(last, this->items.end());
+	this->RebuildIndex();
+}
 
 ScriptList::ScriptList()
 {
 	/* Default sorter */
-	this->sorter         = new ScriptListSorterValueDescending(this);
-	this->sorter_type    = SORT_BY_VALUE;
-	this->sort_ascending = false;
-	this->initialized    = false;
-	this->modifications  = 0;
+	this->sorter_type          = SORT_BY_VALUE;
+	this->sort_ascending       = false;
+	this->initialized          = false;
+	this->modifications        = 0;
+	this->sorted_pos           = 0;
+	this->sorted_modifications = -1;
+	this->items_sorted         = true;
+	this->has_no_more_items    = true;
 }
 
 ScriptList::~ScriptList()
 {
-	delete this->sorter;
 }
 
 bool ScriptList::HasItem(int64 item)
 {
-	return this->items.count(item) == 1;
+	return this->FindPosition(item) != SCRIPT_LIST_NOT_FOUND;
 }
 
 void ScriptList::Clear()
@@ -431,8 +217,11 @@ void ScriptList::Clear()
 	this->modifications++;
 
 	this->items.clear();
-	this->buckets.clear();
-	this->sorter->End();
+	this->index.clear();
+	this->sorted.clear();
+	this->sorted_modifications = -1;
+	this->items_sorted = true;
+	this->has_no_more_items = true;
 }
 
 void ScriptList::AddItem(int64 item, int64 value)
@@ -441,31 +230,66 @@ void ScriptList::AddItem(int64 item, int64 value)
 
 	if (this->HasItem(item)) return;
 
-	this->items[item] = value;
-	this->buckets[value].insert(item);
+	if (!this->items.empty() && this->items.back().item > item) this->items_sorted = false;
+	this->items.push_back({ item, value });
+	this->InsertIndex(this->items.size() - 1);
 }
 
 void ScriptList::RemoveItem(int64 item)
 {
 	this->modifications++;
 
-	ScriptListMap::iterator item_iter = this->items.find(item);
-	if (item_iter == this->items.end()) return;
+	if (this->items.empty()) return;
 
-	int64 value = item_iter->second;
+	size_t slot = this->FindSlot(item);
+	if (this->index[slot] == 0) return;
 
-	this->sorter->Remove(item);
-	ScriptListBucket::iterator bucket_iter = this->buckets.find(value);
-	assert(bucket_iter != this->buckets.end());
-	bucket_iter->second.erase(item);
-	if (bucket_iter->second.empty()) this->buckets.erase(bucket_iter);
-	this->items.erase(item_iter);
+	size_t pos = this->index[slot] - 1;
+	this->EraseIndex(slot);
+
+	/* Move the last item into the hole, so the storage stays dense. */
+	size_t last = this->items.size() - 1;
+	if (pos != last) {
+		this->items[pos] = this->items[last];
+		this->index[this->FindSlot(this->items[pos].item)] = (uint32)(pos + 1);
+		this->items_sorted = false;
+	}
+	this->items.pop_back();
+}
+
+/**
+ * Advance the iteration to the next item that is still in the list.
+ * @return The item at the current position, or 0 when the end is reached.
+ */
+int64 ScriptList::FindNext()
+{
+	/* Items removed after the snapshot was taken are skipped. */
+	while (this->sorted_pos < this->sorted.size() && !this->HasItem(this->sorted[this->sorted_pos].item)) this->sorted_pos++;
+
+	if (this->sorted_pos >= this->sorted.size()) {
+		this->has_no_more_items = true;
+		return 0;
+	}
+	return this->sorted[this->sorted_pos++].item;
 }
 
 int64 ScriptList::Begin()
 {
 	this->initialized = true;
-	return this->sorter->Begin();
+	if (this->items.empty()) return 0;
+
+	/* Only (re)sort when the list changed since the last iteration. */
+	if (this->sorted_modifications != this->modifications) {
+		this->sorted.assign(this->items.begin(), this->items.end());
+		if (this->sorter_type != SORT_BY_ITEM || !this->sort_ascending || !this->items_sorted) {
+			OrderItems(this->sorted.begin(), this->sorted.end(), this->sorted.end(), this->sorter_type, this->sort_ascending);
+		}
+		this->sorted_modifications = this->modifications;
+	}
+
+	this->sorted_pos = 0;
+	this->has_no_more_items = false;
+	return this->FindNext();
 }
 
 int64 ScriptList::Next()
@@ -474,7 +298,8 @@ int64 ScriptList::Next()
 		DEBUG(script, 0, "Next() is invalid as Begin() is never called");
 		return 0;
 	}
-	return this->sorter->Next();
+	if (this->IsEnd()) return 0;
+	return this->FindNext();
 }
 
 bool ScriptList::IsEmpty()
@@ -488,7 +313,7 @@ bool ScriptList::IsEnd()
 		DEBUG(script, 0, "IsEnd() is invalid as Begin() is never called");
 		return true;
 	}
-	return this->sorter->IsEnd();
+	return this->items.empty() || this->has_no_more_items;
 }
 
 int32 ScriptList::Count()
@@ -498,28 +323,18 @@ int32 ScriptList::Count()
 
 int64 ScriptList::GetValue(int64 item)
 {
-	ScriptListMap::const_iterator item_iter = this->items.find(item);
-	return item_iter == this->items.end() ? 0 : item_iter->second;
+	size_t pos = this->FindPosition(item);
+	return pos == SCRIPT_LIST_NOT_FOUND ? 0 : this->items[pos].value;
 }
 
 bool ScriptList::SetValue(int64 item, int64 value)
 {
 	this->modifications++;
 
-	ScriptListMap::iterator item_iter = this->items.find(item);
-	if (item_iter == this->items.end()) return false;
-
-	int64 value_old = item_iter->second;
-	if (value_old == value) return true;
-
-	this->sorter->Remove(item);
-	ScriptListBucket::iterator bucket_iter = this->buckets.find(value_old);
-	assert(bucket_iter != this->buckets.end());
-	bucket_iter->second.erase(item);
-	if (bucket_iter->second.empty()) this->buckets.erase(bucket_iter);
-	item_iter->second = value;
-	this->buckets[value].insert(item);
+	size_t pos = this->FindPosition(item);
+	if (pos == SCRIPT_LIST_NOT_FOUND) return false;
 
+	this->items[pos].value = value;
 	return true;
 }
 
@@ -530,39 +345,33 @@ void ScriptList::Sort(SorterType sorter, bool ascending)
 	if (sorter != SORT_BY_VALUE && sorter != SORT_BY_ITEM) return;
 	if (sorter == this->sorter_type && ascending == this->sort_ascending) return;
 
-	delete this->sorter;
-	switch (sorter) {
-		case SORT_BY_ITEM:
-			if (ascending) {
-				this->sorter = new ScriptListSorterItemAscending(this);
-			} else {
-				this->sorter = new ScriptListSorterItemDescending(this);
-			}
-			break;
-
-		case SORT_BY_VALUE:
-			if (ascending) {
-				this->sorter = new ScriptListSorterValueAscending(this);
-			} else {
-				this->sorter = new ScriptListSorterValueDescending(this);
-			}
-			break;
-
-		default: NOT_REACHED();
-	}
 	this->sorter_type    = sorter;
 	this->sort_ascending = ascending;
 	this->initialized    = false;
+	this->has_no_more_items = true;
 }
 
 void ScriptList::AddList(ScriptList *list)
 {
 	if (list == this) return;
 
-	ScriptListMap *list_items = &list->items;
-	for (ScriptListMap::iterator iter = list_items->begin(); iter != list_items->end(); iter++) {
-		this->AddItem((*iter).first);
-		this->SetValue((*iter).first, (*iter).second);
+	this->modifications++;
+
+	if (this->items.empty()) {
+		/* Plain copy; the index refers to positions, which stay the same. */
+		this->items = list->items;
+		this->index = list->index;
+		this->items_sorted = list->items_sorted;
+		return;
+	}
+
+	for (const ScriptListItem &it : list->items) {
+		size_t pos = this->FindPosition(it.item);
+		if (pos != SCRIPT_LIST_NOT_FOUND) {
+			this->items[pos].value = it.value;
+		} else {
+			this->AddItem(it.item, it.value);
+		}
 	}
 }
 
@@ -571,182 +380,118 @@ void ScriptList::SwapList(ScriptList *list)
 	if (list == this) return;
 
 	this->items.swap(list->items);
-	this->buckets.swap(list->buckets);
-	Swap(this->sorter, list->sorter);
+	this->index.swap(list->index);
+	this->sorted.swap(list->sorted);
+	Swap(this->sorted_pos, list->sorted_pos);
+	Swap(this->sorted_modifications, list->sorted_modifications);
+	Swap(this->items_sorted, list->items_sorted);
+	Swap(this->has_no_more_items, list->has_no_more_items);
 	Swap(this->sorter_type, list->sorter_type);
 	Swap(this->sort_ascending, list->sort_ascending);
 	Swap(this->initialized, list->initialized);
 	Swap(this->modifications, list->modifications);
-	this->sorter->Retarget(this);
-	list->sorter->Retarget(list);
 }
 
 void ScriptList::RemoveAboveValue(int64 value)
 {
-	this->modifications++;
-
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second > value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveItemsIf([value](const ScriptListItem &it) { return it.value > value; });
 }
 
 void ScriptList::RemoveBelowValue(int64 value)
 {
-	this->modifications++;
-
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second < value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveItemsIf([value](const ScriptListItem &it) { return it.value < value; });
 }
 
 void ScriptList::RemoveBetweenValue(int64 start, int64 end)
 {
-	this->modifications++;
-
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second > start && (*iter).second < end) this->RemoveItem((*iter).first);
-	}
+	this->RemoveItemsIf([start, end](const ScriptListItem &it) { return it.value > start && it.value < end; });
 }
 
 void ScriptList::RemoveValue(int64 value)
 {
-	this->modifications++;
-
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second == value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveItemsIf([value](const ScriptListItem &it) { return it.value == value; });
 }
 
 void ScriptList::RemoveTop(int32 count)
 {
 	this->modifications++;
 
-	if (!this->sort_ascending) {
-		this->Sort(this->sorter_type, !this->sort_ascending);
-		this->RemoveBottom(count);
-		this->Sort(this->sorter_type, !this->sort_ascending);
+	if (count <= 0) return;
+	if ((size_t)count >= this->items.size()) {
+		this->Clear();
 		return;
 	}
 
-	switch (this->sorter_type) {
-		default: NOT_REACHED();
-		case SORT_BY_VALUE:
-			for (ScriptListBucket::iterator iter = this->buckets.begin(); iter != this->buckets.end(); iter = this->buckets.begin()) {
-				ScriptItemList *items = &(*iter).second;
-				size_t size = items->size();
-				for (ScriptItemList::iterator iter = items->begin(); iter != items->end(); iter = items->begin()) {
-					if (--count < 0) return;
-					this->RemoveItem(*iter);
-					/* When the last item is removed from the bucket, the bucket itself is removed.
-					 * This means that the iterators can be invalid after a call to RemoveItem.
-					 */
-					if (--size == 0) break;
-				}
-			}
-			break;
-
-		case SORT_BY_ITEM:
-			for (ScriptListMap::iterator iter = this->items.begin(); iter != this->items.end(); iter = this->items.begin()) {
-				if (--count < 0) return;
-				this->RemoveItem((*iter).first);
-			}
-			break;
+	if (this->sorter_type == SORT_BY_ITEM && this->items_sorted) {
+		/* Already in order; the top is either end of the storage. */
+		if (this->sort_ascending) {
+			this->items.erase(this->items.begin(), this->items.begin() + count);
+		} else {
+			this->items.erase(this->items.end() - count, this->items.end());
+		}
+	} else {
+		/* Partition around the cut, no need to sort everything. */
+		OrderItems(this->items.begin(), this->items.begin() + count, this->items.end(), this->sorter_type, this->sort_ascending);
+		this->items.erase(this->items.begin(), this->items.begin() + count);
+		this->items_sorted = false;
 	}
+	this->RebuildIndex();
 }
 
 void ScriptList::RemoveBottom(int32 count)
 {
 	this->modifications++;
 
-	if (!this->sort_ascending) {
-		this->Sort(this->sorter_type, !this->sort_ascending);
-		this->RemoveTop(count);
-		this->Sort(this->sorter_type, !this->sort_ascending);
+	if (count <= 0) return;
+	if ((size_t)count >= this->items.size()) {
+		this->Clear();
 		return;
 	}
 
-	switch (this->sorter_type) {
-		default: NOT_REACHED();
-		case SORT_BY_VALUE:
-			for (ScriptListBucket::reverse_iterator iter = this->buckets.rbegin(); iter != this->buckets.rend(); iter = this->buckets.rbegin()) {
-				ScriptItemList *items = &(*iter).second;
-				size_t size = items->size();
-				for (ScriptItemList::reverse_iterator iter = items->rbegin(); iter != items->rend(); iter = items->rbegin()) {
-					if (--count < 0) return;
-					this->RemoveItem(*iter);
-					/* When the last item is removed from the bucket, the bucket itself is removed.
-					 * This means that the iterators can be invalid after a call to RemoveItem.
-					 */
-					if (--size == 0) break;
-				}
-			}
-			break;
-
-		case SORT_BY_ITEM:
-			for (ScriptListMap::reverse_iterator iter = this->items.rbegin(); iter != this->items.rend(); iter = this->items.rbegin()) {
-				if (--count < 0) return;
-				this->RemoveItem((*iter).first);
-			}
-			break;
+	if (this->sorter_type == SORT_BY_ITEM && this->items_sorted) {
+		/* Already in order; the bottom is either end of the storage. */
+		if (this->sort_ascending) {
+			this->items.erase(this->items.end() - count, this->items.end());
+		} else {
+			this->items.erase(this->items.begin(), this->items.begin() + count);
+		}
+	} else {
+		/* Partition around the cut, no need to sort everything. */
+		OrderItems(this->items.begin(), this->items.end() - count, this->items.end(), this->sorter_type, this->sort_ascending);
+		this->items.erase(this->items.end() - count, this->items.end());
+		this->items_sorted = false;
 	}
+	this->RebuildIndex();
 }
 
 void ScriptList::RemoveList(ScriptList *list)
 {
-	this->modifications++;
-
 	if (list == this) {
-		Clear();
-	} else {
-		ScriptListMap *list_items = &list->items;
-		for (ScriptListMap::iterator iter = list_items->begin(); iter != list_items->end(); iter++) {
-			this->RemoveItem((*iter).first);
-		}
+		this->Clear();
+		return;
 	}
+
+	this->RemoveItemsIf([list](const ScriptListItem &it) { return list->HasItem(it.item); });
 }
 
 void ScriptList::KeepAboveValue(int64 value)
 {
-	this->modifications++;
-
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second <= value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveItemsIf([value](const ScriptListItem &it) { return it.value <= value; });
 }
 
 void ScriptList::KeepBelowValue(int64 value)
 {
-	this->modifications++;
-
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second >= value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveItemsIf([value](const ScriptListItem &it) { return it.value >= value; });
 }
 
 void ScriptList::KeepBetweenValue(int64 start, int64 end)
 {
-	this->modifications++;
-
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second <= start || (*iter).second >= end) this->RemoveItem((*iter).first);
-	}
+	this->RemoveItemsIf([start, end](const ScriptListItem &it) { return it.value <= start || it.value >= end; });
 }
 
 void ScriptList::KeepValue(int64 value)
 {
-	this->modifications++;
-
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second != value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveItemsIf([value](const ScriptListItem &it) { return it.value != value; });
 }
 
 void ScriptList::KeepTop(int32 count)
@@ -767,12 +512,7 @@ void ScriptList::KeepList(ScriptList *list)
 {
 	if (list == this) return;
 
-	this->modifications++;
-
-	ScriptList tmp;
-	tmp.AddList(this);
-	tmp.RemoveList(list);
-	this->RemoveList(&tmp);
+	this->RemoveItemsIf([list](const ScriptListItem &it) { return !list->HasItem(it.item); });
 }
 
 SQInteger ScriptList::_get(HSQUIRRELVM vm)
@@ -782,10 +522,10 @@ SQInteger ScriptList::_get(HSQUIRRELVM vm)
 	SQInteger idx;
 	sq_getinteger(vm, 2, &idx);
 
-	ScriptListMap::const_iterator item_iter = this->items.find(idx);
-	if (item_iter == this->items.end()) return SQ_ERROR;
+	size_t pos = this->FindPosition(idx);
+	if (pos == SCRIPT_LIST_NOT_FOUND) return SQ_ERROR;
 
-	sq_pushinteger(vm, item_iter->second);
+	sq_pushinteger(vm, this->items[pos].value);
 	return 1;
 }
 
@@ -837,6 +577,13 @@ SQInteger ScriptList::_nexti(HSQUIRRELVM vm)
 	return 1;
 }
 
+void ScriptList::ValuateNative(NativeValuator *valuator, int64 param)
+{
+	this->modifications++;
+
+	for (ScriptListItem &it : this->items) it.value = valuator(it.item, param);
+}
+
 SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 {
 	this->modifications++;
@@ -864,16 +611,19 @@ SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 	/* Push the function to call */
 	sq_push(vm, 2);
 
-	for (ScriptListMap::iterator iter = this->items.begin(); iter != this->items.end(); iter++) {
+	/* Valuate in item order, as scripts may depend on the order valuators are called in. */
+	this->SortByItem();
+
+	for (size_t i = 0; i < this->items.size(); i++) {
 		/* Check for changing of items. */
 		int previous_modification_count = this->modifications;
 
 		/* Push the root table as instance object, this is what squirrel does for meta-functions. */
 		sq_pushroottable(vm);
 		/* Push all arguments for the valuator function. */
-		sq_pushinteger(vm, (*iter).first);
-		for (int i = 0; i < nparam - 1; i++) {
-			sq_push(vm, i + 3);
+		sq_pushinteger(vm, this->items[i].item);
+		for (int p = 0; p < nparam - 1; p++) {
+			sq_push(vm, p + 3);
 		}
 
 		/* Call the function. Squirrel pops all parameters and pushes the return value. */
@@ -925,7 +675,7 @@ SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 			return sq_throwerror(vm, "modifying valuated list outside of valuator function");
 		}
 
-		this->SetValue((*iter).first, value);
+		this->items[i].value = value;
 
 		/* Pop the return value. */
 		sq_poptop(vm);
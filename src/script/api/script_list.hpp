@@ -14,10 +14,7 @@
 #define SCRIPT_LIST_HPP
 
 #include "script_object.hpp"
-#include <map>
-#include <set>
-
-class ScriptListSorter;
+#include <vector>
 
 /**
  * Class that creates a list which can keep item/value pairs, which you can walk.
@@ -37,20 +34,35 @@ public:
 	static const bool SORT_DESCENDING = false;
 
 private:
-	ScriptListSorter *sorter;     ///< Sorting algorithm
-	SorterType sorter_type;       ///< Sorting type
-	bool sort_ascending;          ///< Whether to sort ascending or descending
-	bool initialized;             ///< Whether an iteration has been started
-	int modifications;            ///< Number of modification that has been done. To prevent changing data while valuating.
-
-public:
-	typedef std::set<int64> ScriptItemList;                   ///< The list of items inside the bucket
-	typedef std::map<int64, ScriptItemList> ScriptListBucket; ///< The bucket list per value
-	typedef std::map<int64, int64> ScriptListMap;             ///< List per item
+	/** A single item/value pair of the list. */
+	struct ScriptListItem {
+		int64 item;  ///< The item itself.
+		int64 value; ///< The value belonging to the item.
+	};
 
-	ScriptListMap items;           ///< The items in the list
-	ScriptListBucket buckets;      ///< The items in the list, sorted by value
+	std::vector<ScriptListItem> items;  ///< The items in the list, in no particular order unless #items_sorted is set.
+	std::vector<uint32> index;          ///< Open addressing hash of the items; a slot holds the position in #items plus one, 0 is an empty slot.
+	std::vector<ScriptListItem> sorted; ///< Snapshot of the items in the order of the sorter, built lazily when iterating.
+	size_t sorted_pos;                  ///< Position in #sorted of the item Next() will return.
+	int sorted_modifications;           ///< Value of #modifications when #sorted was built, -1 if it is not built.
+	bool items_sorted;                  ///< Whether #items is sorted by item, ascending.
+	bool has_no_more_items;             ///< Whether the iteration has reached the end.
+	SorterType sorter_type;             ///< Sorting type
+	bool sort_ascending;                ///< Whether to sort ascending or descending
+	bool initialized;                   ///< Whether an iteration has been started
+	int modifications;                  ///< Number of modification that has been done. To prevent changing data while valuating.
+
+	size_t FindSlot(int64 item) const;
+	size_t FindPosition(int64 item) const;
+	void InsertIndex(size_t pos);
+	void EraseIndex(size_t slot);
+	void RebuildIndex();
+	void SortByItem();
+	int64 FindNext();
+	template <typename Tpredicate> void RemoveItemsIf(Tpredicate predicate);
+	static void OrderItems(std::vector<ScriptListItem>::iterator first, std::vector<ScriptListItem>::iterator nth, std::vector<ScriptListItem>::iterator last, SorterType sorter, bool ascending);
 
+public:
 	ScriptList();
 	~ScriptList();
 
@@ -130,6 +142,8 @@ public:
 	 * @return true if we could set the item to value, false otherwise.
 	 * @note Changing values of items while looping through a list might cause
 	 *  entries to be skipped. Be very careful with such operations.
+	 * @note A loop goes through the items that were in the list when it started:
+	 *  items added during the loop are not visited, items removed are skipped.
 	 */
 	bool SetValue(int64 item, int64 value);
 
@@ -288,6 +302,18 @@ public:
 	 */
 	void Valuate(void *valuator_function, int params, ...);
 #endif /* DOXYGEN_API */
+
+protected:
+	/** A valuator implemented in C++: gets the value of an item, given a parameter. */
+	typedef int64 NativeValuator(int64 item, int64 param);
+
+	/**
+	 * Give all items a value defined by a valuator implemented in C++, so
+	 *  without calling into the script for every item.
+	 * @param valuator The function which will be doing the valuation.
+	 * @param param The parameter to give to the valuator.
+	 */
+	void ValuateNative(NativeValuator *valuator, int64 param);
 };
 
 #endif /* SCRIPT_LIST_HPP */
@@ -38,7 +38,7 @@ static ScriptStorage *GetStorage()
 }
 
 
-/* static */ ScriptInstance *ScriptObject::ActiveInstance::active = nullptr;
+/* static */ thread_local ScriptInstance *ScriptObject::ActiveInstance::active = nullptr;
 
 ScriptObject::ActiveInstance::ActiveInstance(ScriptInstance *instance)
 {
@@ -49,7 +49,7 @@ protected:
 	private:
 		ScriptInstance *last_active;    ///< The active instance before we go instantiated.
 
-		static ScriptInstance *active;  ///< The global current active instance.
+		static thread_local ScriptInstance *active; ///< The current active instance of this thread.
 	};
 
 public:
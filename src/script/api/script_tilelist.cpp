@@ -12,6 +12,7 @@
 #include "../../stdafx.h"
 #include "script_tilelist.hpp"
 #include "script_industry.hpp"
+#include "script_tile.hpp"
 #include "../../industry.h"
 #include "../../station_base.h"
 
@@ -159,3 +160,35 @@ ScriptTileList_StationType::ScriptTileList_StationType(StationID station_id, Scr
 		this->AddTile(cur_tile);
 	}
 }
+
+ScriptTileList_Property::ScriptTileList_Property(TileIndex tile_from, TileIndex tile_to, ScriptTileList_Property::TileProperty property)
+{
+	if (!::IsValidTile(tile_from)) return;
+	if (!::IsValidTile(tile_to)) return;
+
+	TileArea ta(tile_from, tile_to);
+	TILE_AREA_LOOP(t, ta) this->AddItem(t, GetProperty(t, property));
+}
+
+void ScriptTileList_Property::SetProperty(TileProperty property)
+{
+	this->ValuateNative(&ScriptTileList_Property::GetProperty, property);
+}
+
+/* static */ int64 ScriptTileList_Property::GetProperty(int64 item, int64 property)
+{
+	/* Items added by the script need not be tiles; don't let them wrap around to one. */
+	TileIndex tile = (item >= 0 && item < (int64)::MapSize()) ? (TileIndex)item : INVALID_TILE;
+
+	switch (property) {
+		case TP_MIN_HEIGHT:     return ScriptTile::GetMinHeight(tile);
+		case TP_MAX_HEIGHT:     return ScriptTile::GetMaxHeight(tile);
+		case TP_SLOPE:          return ScriptTile::GetSlope(tile);
+		case TP_TILE_TYPE:      return ::IsValidTile(tile) ? (int64)::GetTileType(tile) : -1;
+		case TP_TERRAIN_TYPE:   return ScriptTile::GetTerrainType(tile);
+		case TP_OWNER:          return ScriptTile::GetOwner(tile);
+		case TP_BUILDABLE:      return ScriptTile::IsBuildable(tile) ? 1 : 0;
+		case TP_TOWN_AUTHORITY: return ScriptTile::GetTownAuthority(tile);
+		default:                return -1;
+	}
+}
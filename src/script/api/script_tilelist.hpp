@@ -14,6 +14,7 @@
 
 #include "script_station.hpp"
 #include "script_list.hpp"
+#include "../../tile_type.h"
 
 /**
  * Creates an empty list, in which you can add tiles.
@@ -106,4 +107,71 @@ public:
 	ScriptTileList_StationType(StationID station_id, ScriptStation::StationType station_type);
 };
 
+/**
+ * Creates a list of the tiles in a rectangle, with a property of each tile as value.
+ *  The whole rectangle is queried in one call, so searching for a site does not
+ *  need a call to ScriptTile for every tile; filter the list on its values instead.
+ * @api ai game
+ * @ingroup ScriptList
+ */
+class ScriptTileList_Property : public ScriptTileList {
+public:
+	/**
+	 * The properties of a tile that can be queried.
+	 */
+	enum TileProperty {
+		TP_MIN_HEIGHT,     ///< The height of the lowest corner, see ScriptTile::GetMinHeight.
+		TP_MAX_HEIGHT,     ///< The height of the highest corner, see ScriptTile::GetMaxHeight.
+		TP_SLOPE,          ///< The slope, see ScriptTile::GetSlope.
+		TP_TILE_TYPE,      ///< What is on the tile, see TileType; -1 for an invalid tile.
+		TP_TERRAIN_TYPE,   ///< The terrain, see ScriptTile::GetTerrainType.
+		TP_OWNER,          ///< The owner, see ScriptTile::GetOwner.
+		TP_BUILDABLE,      ///< 1 if the tile is buildable, otherwise 0; see ScriptTile::IsBuildable.
+		TP_TOWN_AUTHORITY, ///< The town that has authority over the tile, see ScriptTile::GetTownAuthority.
+	};
+
+	/**
+	 * What is on a tile.
+	 */
+	enum TileType {
+		/* Note: these values represent part of the in-game TileType enum */
+		TT_CLEAR        = ::MP_CLEAR,        ///< Nothing, or fields, rocks or snow.
+		TT_RAILWAY      = ::MP_RAILWAY,      ///< Railway tracks or depot.
+		TT_ROAD         = ::MP_ROAD,         ///< Road, level crossing or road depot.
+		TT_HOUSE        = ::MP_HOUSE,        ///< A town building.
+		TT_TREES        = ::MP_TREES,        ///< Trees.
+		TT_STATION      = ::MP_STATION,      ///< A station, waypoint or oil rig.
+		TT_WATER        = ::MP_WATER,        ///< Water, coast, canal, lock or ship depot.
+		TT_VOID         = ::MP_VOID,         ///< The invisible tiles at the edge of the map.
+		TT_INDUSTRY     = ::MP_INDUSTRY,     ///< Part of an industry.
+		TT_TUNNELBRIDGE = ::MP_TUNNELBRIDGE, ///< The head of a tunnel or bridge.
+		TT_OBJECT       = ::MP_OBJECT,       ///< An object, like a transmitter, lighthouse or company headquarters.
+	};
+
+	/**
+	 * @param tile_from One corner of the tiles to add.
+	 * @param tile_to The other corner of the tiles to add.
+	 * @param property The property to use as value of the tiles.
+	 * @pre ScriptMap::IsValidTile(tile_from).
+	 * @pre ScriptMap::IsValidTile(tile_to).
+	 */
+	ScriptTileList_Property(TileIndex tile_from, TileIndex tile_to, ScriptTileList_Property::TileProperty property);
+
+	/**
+	 * Set the value of all tiles in the list to another property, for example
+	 *  to filter on a second property after filtering on the first.
+	 * @param property The property to use as value of the tiles.
+	 */
+	void SetProperty(TileProperty property);
+
+private:
+	/**
+	 * Get a property of a tile.
+	 * @param item The tile to query.
+	 * @param property The property to get, a TileProperty.
+	 * @return The value of the property.
+	 */
+	static int64 GetProperty(int64 item, int64 property);
+};
+
 #endif /* SCRIPT_TILELIST_HPP */
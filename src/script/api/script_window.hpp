@@ -930,6 +930,7 @@ public:
 		WID_AID_BREAK_STR_EDIT_BOX                   = ::WID_AID_BREAK_STR_EDIT_BOX,                   ///< Edit box for the string to break on.
 		WID_AID_MATCH_CASE_BTN                       = ::WID_AID_MATCH_CASE_BTN,                       ///< Checkbox to use match caching or not.
 		WID_AID_CONTINUE_BTN                         = ::WID_AID_CONTINUE_BTN,                         ///< Continue button.
+		WID_AID_PROFILE                              = ::WID_AID_PROFILE,                              ///< Profiling counters of the script.
 	};
 
 	/* automatically generated from ../../widgets/airport_widget.h */
@@ -172,6 +172,9 @@ void ScriptInstance::GameLoop()
 	if (this->is_paused) return;
 	this->controller->ticks++;
 
+	/* Continue a running incremental garbage collection; the script, and so its suspend counting, waits until it is done. */
+	if (this->engine->IsCollectingGarbage() && !this->StepGarbageCollection()) return;
+
 	if (this->suspend   < -1) this->suspend++; // Multiplayer suspend, increase up to -1.
 	if (this->suspend   < 0)  return;          // Multiplayer suspend, wait for Continue().
 	if (--this->suspend > 0)  return;          // Singleplayer suspend, decrease to 0.
@@ -250,7 +253,24 @@ void ScriptInstance::GameLoop()
 
 void ScriptInstance::CollectGarbage() const
 {
-	if (this->is_started && !this->IsDead()) this->engine->CollectGarbage();
+	if (!this->is_started || this->IsDead()) return;
+
+	if (_settings_game.script.script_gc_budget == 0) {
+		this->engine->CollectGarbage();
+	} else {
+		this->StepGarbageCollection();
+	}
+}
+
+bool ScriptInstance::StepGarbageCollection() const
+{
+	uint budget = _settings_game.script.script_gc_budget;
+	if (budget == 0) {
+		/* Incremental collection was switched off while one was running. */
+		this->engine->CollectGarbage();
+		return true;
+	}
+	return this->engine->CollectGarbageStep(budget);
 }
 
 /* static */ void ScriptInstance::DoCommandReturn(ScriptInstance *instance)
@@ -678,6 +698,11 @@ SQInteger ScriptInstance::GetOpsTillSuspend()
 	return this->engine->GetOpsTillSuspend();
 }
 
+SquirrelProfile ScriptInstance::GetProfile() const
+{
+	return this->engine->GetProfile();
+}
+
 void ScriptInstance::DoCommandCallback(const CommandCost &result, TileIndex tile, uint32 p1, uint32 p2)
 {
 	ScriptObject::ActiveInstance active(this);
@@ -14,6 +14,7 @@
 
 #include <squirrel.h>
 #include "script_suspend.hpp"
+#include "squirrel.hpp"
 
 #include "../command_type.h"
 #include "../company_type.h"
@@ -68,7 +69,8 @@ public:
 	void GameLoop();
 
 	/**
-	 * Let the VM collect any garbage.
+	 * Let the VM collect any garbage. With a garbage collection budget set,
+	 *  this starts an incremental collection, which continues in the next ticks.
 	 */
 	void CollectGarbage() const;
 
@@ -176,6 +178,12 @@ public:
 	 */
 	SQInteger GetOpsTillSuspend();
 
+	/**
+	 * Get the profiling counters of the VM of the script.
+	 * @return The operations, allocations and garbage collection work of the script so far.
+	 */
+	SquirrelProfile GetProfile() const;
+
 	/**
 	 * DoCommand callback function for all commands executed by scripts.
 	 * @param result The result of the command.
@@ -248,6 +256,12 @@ private:
 	 */
 	bool CallLoad();
 
+	/**
+	 * Do the part of an incremental garbage collection that fits the budget of this tick.
+	 * @return True if the collection is done.
+	 */
+	bool StepGarbageCollection() const;
+
 	/**
 	 * Save one object (int / string / array / table) to the savegame.
 	 * @param vm The virtual machine to get all the data from.
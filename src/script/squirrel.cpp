@@ -15,18 +15,122 @@
 #include "squirrel_std.hpp"
 #include "../fileio_func.h"
 #include "../string_func.h"
+#include "../company_func.h"
 #include <sqstdaux.h>
 #include <../squirrel/sqpcheader.h>
 #include <../squirrel/sqvm.h>
+#include <mutex>
+#include <condition_variable>
+#if defined(__MINGW32__)
+#include "../3rdparty/mingw-std-threads/mingw.mutex.h"
+#include "../3rdparty/mingw-std-threads/mingw.condition_variable.h"
+#endif
 
 #include "../safeguards.h"
 
+static std::mutex _squirrel_api_mutex;                ///< Serialises the access to the game of script worker threads.
+static std::condition_variable _squirrel_api_turn_changed; ///< Signalled when the next script gets its turn to access the game.
+static uint _squirrel_api_turn;                       ///< Turn of the script which may access the game, protected by #_squirrel_api_mutex.
+static thread_local bool _squirrel_worker_thread;     ///< Whether the current thread is a script worker thread.
+static thread_local int _squirrel_api_depth;          ///< Nesting depth of #SquirrelAPIScope; the API lock is held while it is non-zero.
+static thread_local CompanyID _squirrel_worker_company; ///< #_current_company of the script on this thread, while it does not hold the API lock.
+static thread_local uint _squirrel_worker_turn;       ///< Turn of the script on this thread.
+
+/**
+ * Take the script API lock for this worker thread, and switch to its company.
+ * The lock is only given once all scripts with an earlier turn are done, so
+ * the scripts see and change the game in the same order as without threads.
+ */
+static void AcquireSquirrelAPI()
+{
+	std::unique_lock<std::mutex> lock(_squirrel_api_mutex);
+	_squirrel_api_turn_changed.wait(lock, []() { return _squirrel_api_turn == _squirrel_worker_turn; });
+	lock.release();
+	_current_company = _squirrel_worker_company;
+}
+
+/** Remember the company of this worker thread, and release the script API lock. */
+static void ReleaseSquirrelAPI()
+{
+	_squirrel_worker_company = _current_company;
+	_squirrel_api_mutex.unlock();
+}
+
+/* static */ void Squirrel::ResetWorkerTurns()
+{
+	std::lock_guard<std::mutex> lock(_squirrel_api_mutex);
+	_squirrel_api_turn = 0;
+}
+
+/* static */ void Squirrel::EnterWorkerThread(CompanyID company, uint turn)
+{
+	assert(!_squirrel_worker_thread);
+	_squirrel_worker_thread = true;
+	_squirrel_worker_company = company;
+	_squirrel_worker_turn = turn;
+	/* The script instance does not touch the game state before it enters the
+	 * VM, so this does not have to wait for the turn of the script. */
+	_squirrel_api_mutex.lock();
+	_current_company = company;
+	_squirrel_api_depth = 1;
+}
+
+/* static */ void Squirrel::LeaveWorkerThread()
+{
+	assert(_squirrel_worker_thread && _squirrel_api_depth == 1);
+	_squirrel_api_depth = 0;
+	ReleaseSquirrelAPI();
+
+	/* Pass the turn on, also when the script did not need it this tick. */
+	AcquireSquirrelAPI();
+	_squirrel_api_turn++;
+	_squirrel_api_mutex.unlock();
+	_squirrel_api_turn_changed.notify_all();
+	_squirrel_worker_thread = false;
+}
+
+/* static */ bool Squirrel::IsWorkerThread()
+{
+	return _squirrel_worker_thread;
+}
+
+SquirrelAPIScope::SquirrelAPIScope()
+{
+	if (_squirrel_worker_thread && _squirrel_api_depth++ == 0) AcquireSquirrelAPI();
+}
+
+SquirrelAPIScope::~SquirrelAPIScope()
+{
+	if (_squirrel_worker_thread && --_squirrel_api_depth == 0) ReleaseSquirrelAPI();
+}
+
+SquirrelExecutionScope::SquirrelExecutionScope()
+{
+	/* Only release the lock when the VM is entered from the script instance
+	 * itself; a VM called back from within the API keeps holding it. */
+	this->released = _squirrel_worker_thread && _squirrel_api_depth == 1;
+	if (this->released) {
+		_squirrel_api_depth = 0;
+		ReleaseSquirrelAPI();
+	}
+}
+
+SquirrelExecutionScope::~SquirrelExecutionScope()
+{
+	if (this->released) {
+		AcquireSquirrelAPI();
+		_squirrel_api_depth = 1;
+	}
+}
+
 void Squirrel::CompileError(HSQUIRRELVM vm, const SQChar *desc, const SQChar *source, SQInteger line, SQInteger column)
 {
 	SQChar buf[1024];
 
 	seprintf(buf, lastof(buf), "Error %s:" OTTD_PRINTF64 "/" OTTD_PRINTF64 ": %s", source, line, column, desc);
 
+	SquirrelAPIScope api_scope;
+
 	/* Check if we have a custom print function */
 	Squirrel *engine = (Squirrel *)sq_getforeignptr(vm);
 	engine->crashed = true;
@@ -47,6 +151,8 @@ void Squirrel::ErrorPrintFunc(HSQUIRRELVM vm, const SQChar *s, ...)
 	vseprintf(buf, lastof(buf), s, arglist);
 	va_end(arglist);
 
+	SquirrelAPIScope api_scope;
+
 	/* Check if we have a custom print function */
 	SQPrintFunc *func = ((Squirrel *)sq_getforeignptr(vm))->print_func;
 	if (func == nullptr) {
@@ -58,6 +164,8 @@ void Squirrel::ErrorPrintFunc(HSQUIRRELVM vm, const SQChar *s, ...)
 
 void Squirrel::RunError(HSQUIRRELVM vm, const SQChar *error)
 {
+	SquirrelAPIScope api_scope;
+
 	/* Set the print function to something that prints to stderr */
 	SQPRINTFUNCTION pf = sq_getprintfunc(vm);
 	sq_setprintfunc(vm, &Squirrel::ErrorPrintFunc);
@@ -104,6 +212,8 @@ void Squirrel::PrintFunc(HSQUIRRELVM vm, const SQChar *s, ...)
 	va_end(arglist);
 	strecat(buf, "\n", lastof(buf));
 
+	SquirrelAPIScope api_scope;
+
 	/* Check if we have a custom print function */
 	SQPrintFunc *func = ((Squirrel *)sq_getforeignptr(vm))->print_func;
 	if (func == nullptr) {
@@ -187,6 +297,7 @@ bool Squirrel::MethodExists(HSQOBJECT instance, const char *method_name)
 bool Squirrel::Resume(int suspend)
 {
 	assert(!this->crashed);
+	this->FinishGarbageCollection();
 	/* Did we use more operations than we should have in the
 	 * previous tick? If so, subtract that from the current run. */
 	if (this->overdrawn_ops > 0 && suspend > 0) {
@@ -198,7 +309,10 @@ bool Squirrel::Resume(int suspend)
 		suspend = -this->overdrawn_ops;
 	}
 
-	this->crashed = !sq_resumecatch(this->vm, suspend);
+	{
+		SquirrelExecutionScope execution_scope;
+		this->crashed = !sq_resumecatch(this->vm, suspend);
+	}
 	this->overdrawn_ops = -this->vm->_ops_till_suspend;
 	return this->vm->_suspended != 0;
 }
@@ -206,17 +320,67 @@ bool Squirrel::Resume(int suspend)
 void Squirrel::ResumeError()
 {
 	assert(!this->crashed);
+	this->FinishGarbageCollection();
 	sq_resumeerror(this->vm);
 }
 
+/**
+ * Account a pause of the script for garbage collection.
+ * @param start The moment the pause started.
+ * @param collected The number of objects the finished collection freed, or -1 if it is not finished yet.
+ */
+void Squirrel::AddGarbageCollectionPause(std::chrono::steady_clock::time_point start, SQInteger collected)
+{
+	uint64 pause = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	this->gc_time += pause;
+	this->gc_max_pause = max(this->gc_max_pause, pause);
+	if (collected >= 0) {
+		this->gc_runs++;
+		this->gc_collected += collected;
+	}
+}
+
 void Squirrel::CollectGarbage()
 {
-	sq_collectgarbage(this->vm);
+	auto start = std::chrono::steady_clock::now();
+	SQInteger collected = sq_collectgarbage(this->vm);
+	this->AddGarbageCollectionPause(start, collected);
+}
+
+bool Squirrel::CollectGarbageStep(uint budget)
+{
+	/* Checking the clock after every object would cost more than scanning most of them. */
+	static const SQInteger GC_STEP_WORK = 32;
+
+	auto start = std::chrono::steady_clock::now();
+	auto deadline = start + std::chrono::microseconds(budget);
+	sq_collectgarbage_start(this->vm);
+
+	SQInteger collected;
+	while (!sq_collectgarbage_step(this->vm, GC_STEP_WORK, &collected)) {
+		if (std::chrono::steady_clock::now() >= deadline) {
+			this->AddGarbageCollectionPause(start, -1);
+			return false;
+		}
+	}
+	this->AddGarbageCollectionPause(start, collected);
+	return true;
+}
+
+bool Squirrel::IsCollectingGarbage()
+{
+	return sq_collectgarbage_running(this->vm);
+}
+
+void Squirrel::FinishGarbageCollection()
+{
+	if (this->IsCollectingGarbage()) this->CollectGarbage();
 }
 
 bool Squirrel::CallMethod(HSQOBJECT instance, const char *method_name, HSQOBJECT *ret, int suspend)
 {
 	assert(!this->crashed);
+	this->FinishGarbageCollection();
 	/* Store the stack-location for the return value. We need to
 	 * restore this after saving or the stack will be corrupted
 	 * if we're in the middle of a DoCommand. */
@@ -234,7 +398,10 @@ bool Squirrel::CallMethod(HSQOBJECT instance, const char *method_name, HSQOBJECT
 	}
 	/* Call the method */
 	sq_pushobject(this->vm, instance);
-	if (SQ_FAILED(sq_call(this->vm, 1, ret == nullptr ? SQFalse : SQTrue, SQTrue, suspend))) return false;
+	{
+		SquirrelExecutionScope execution_scope;
+		if (SQ_FAILED(sq_call(this->vm, 1, ret == nullptr ? SQFalse : SQTrue, SQTrue, suspend))) return false;
+	}
 	if (ret != nullptr) sq_getstackobj(vm, -1, ret);
 	/* Reset the top, but don't do so for the script main function, as we need
 	 *  a correct stack when resuming. */
@@ -340,6 +507,10 @@ void Squirrel::Initialize()
 	this->print_func = nullptr;
 	this->crashed = false;
 	this->overdrawn_ops = 0;
+	this->gc_runs = 0;
+	this->gc_time = 0;
+	this->gc_max_pause = 0;
+	this->gc_collected = 0;
 	this->vm = sq_open(1024);
 
 	/* Handle compile-errors ourself, so we can display it nicely */
@@ -607,3 +778,18 @@ SQInteger Squirrel::GetOpsTillSuspend()
 {
 	return this->vm->_ops_till_suspend;
 }
+
+SquirrelProfile Squirrel::GetProfile()
+{
+	const SQAllocPool &pool = _ss(this->vm)->_pool;
+
+	SquirrelProfile profile;
+	profile.ops = this->vm->_ops_total;
+	profile.allocations = pool._allocs;
+	profile.pool_bytes = pool._bytes_reserved;
+	profile.gc_runs = this->gc_runs;
+	profile.gc_time = this->gc_time;
+	profile.gc_max_pause = this->gc_max_pause;
+	profile.gc_collected = this->gc_collected;
+	return profile;
+}
@@ -13,6 +13,8 @@
 #define SQUIRREL_HPP
 
 #include <squirrel.h>
+#include "../company_type.h"
+#include <chrono>
 
 /** The type of script we're working with, i.e. for who is it? */
 enum ScriptType {
@@ -20,6 +22,17 @@ enum ScriptType {
 	ST_GS, ///< The script is for Game scripts.
 };
 
+/** Counters about the work done by the VM of a script, for profiling. */
+struct SquirrelProfile {
+	uint64 ops;         ///< Number of operations executed by the VM.
+	uint64 allocations; ///< Number of tables, arrays and closures allocated.
+	uint64 pool_bytes;  ///< Bytes reserved by the allocation pool of the VM.
+	uint gc_runs;       ///< Number of garbage collection runs.
+	uint64 gc_time;     ///< Time spent in garbage collection, in microseconds.
+	uint64 gc_max_pause;  ///< Longest time the script was stopped for one garbage collection (step), in microseconds.
+	uint64 gc_collected;  ///< Number of objects freed by garbage collection.
+};
+
 class Squirrel {
 private:
 	typedef void (SQPrintFunc)(bool error_msg, const SQChar *message);
@@ -29,6 +42,10 @@ private:
 	SQPrintFunc *print_func; ///< Points to either nullptr, or a custom print handler
 	bool crashed;            ///< True if the squirrel script made an error.
 	int overdrawn_ops;       ///< The amount of operations we have overdrawn.
+	uint gc_runs;            ///< The number of garbage collection runs.
+	uint64 gc_time;          ///< The time spent in garbage collection, in microseconds.
+	uint64 gc_max_pause;     ///< The longest garbage collection (step), in microseconds.
+	uint64 gc_collected;     ///< The number of objects freed by garbage collection.
 	const char *APIName;     ///< Name of the API used for this squirrel.
 
 	/**
@@ -41,6 +58,13 @@ private:
 	 */
 	const char *GetAPIName() { return this->APIName; }
 
+	void AddGarbageCollectionPause(std::chrono::steady_clock::time_point start, SQInteger collected);
+
+	/**
+	 * Finish the running incremental garbage collection, if any, before the VM runs script code again.
+	 */
+	void FinishGarbageCollection();
+
 	/** Perform all initialization steps to create the engine. */
 	void Initialize();
 	/** Perform all the cleanups for the engine. */
@@ -142,10 +166,23 @@ public:
 	void ResumeError();
 
 	/**
-	 * Tell the VM to do a garbage collection run.
+	 * Tell the VM to do a garbage collection run, or to finish the running incremental one.
 	 */
 	void CollectGarbage();
 
+	/**
+	 * Do a part of an incremental garbage collection, and start one if none is running.
+	 * The script must not run until the collection is done.
+	 * @param budget The time the step may take, in microseconds.
+	 * @return True if the collection is done.
+	 */
+	bool CollectGarbageStep(uint budget);
+
+	/**
+	 * Is an incremental garbage collection running?
+	 */
+	bool IsCollectingGarbage();
+
 	void InsertResult(bool result);
 	void InsertResult(int result);
 	void InsertResult(uint result) { this->InsertResult((int)result); }
@@ -235,7 +272,11 @@ public:
 	/**
 	 * Release a SQ object.
 	 */
-	void ReleaseObject(HSQOBJECT *ptr) { sq_release(this->vm, ptr); }
+	void ReleaseObject(HSQOBJECT *ptr)
+	{
+		this->FinishGarbageCollection();
+		sq_release(this->vm, ptr);
+	}
 
 	/**
 	 * Tell the VM to remove \c amount ops from the number of ops till suspend.
@@ -268,10 +309,62 @@ public:
 	 */
 	SQInteger GetOpsTillSuspend();
 
+	/**
+	 * Get the profiling counters of the VM.
+	 */
+	SquirrelProfile GetProfile();
+
 	/**
 	 * Completely reset the engine; start from scratch.
 	 */
 	void Reset();
+
+	/**
+	 * Start a new round of scripts on worker threads, the first script to access the game is the one with turn 0.
+	 * @pre No script worker threads are running.
+	 */
+	static void ResetWorkerTurns();
+
+	/**
+	 * Mark the current thread as a script worker thread, and take the script API lock.
+	 * @param company The company the script on this thread runs for.
+	 * @param turn Position of the script in the order in which the scripts access the game, see #ResetWorkerTurns.
+	 */
+	static void EnterWorkerThread(CompanyID company, uint turn);
+
+	/**
+	 * Release the script API lock, pass the turn to the next script once it is ours, and stop being a script worker thread.
+	 */
+	static void LeaveWorkerThread();
+
+	/**
+	 * Is the current thread a script worker thread?
+	 */
+	static bool IsWorkerThread();
+};
+
+/**
+ * Scope for C++ code called from a script VM, which may touch the game state.
+ * On a script worker thread this holds the script API lock, so only one
+ * script at a time is inside the game, in the order of their turns.
+ * Elsewhere it does nothing.
+ */
+class SquirrelAPIScope {
+public:
+	SquirrelAPIScope();
+	~SquirrelAPIScope();
+};
+
+/**
+ * Scope in which a script VM executes bytecode. On a script worker thread
+ * the script API lock is released, so the VMs of the scripts run in parallel.
+ */
+class SquirrelExecutionScope {
+	bool released; ///< Whether the script API lock was released by this scope.
+
+public:
+	SquirrelExecutionScope();
+	~SquirrelExecutionScope();
 };
 
 #endif /* SQUIRREL_HPP */
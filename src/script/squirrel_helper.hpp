@@ -737,6 +737,8 @@ namespace SQConvert {
 	template <typename Tcls, typename Tmethod, ScriptType Ttype>
 	inline SQInteger DefSQNonStaticCallback(HSQUIRRELVM vm)
 	{
+		SquirrelAPIScope api_scope;
+
 		/* Find the amount of params we got */
 		int nparam = sq_gettop(vm);
 		SQUserPointer ptr = nullptr;
@@ -779,6 +781,8 @@ namespace SQConvert {
 	template <typename Tcls, typename Tmethod, ScriptType Ttype>
 	inline SQInteger DefSQAdvancedNonStaticCallback(HSQUIRRELVM vm)
 	{
+		SquirrelAPIScope api_scope;
+
 		/* Find the amount of params we got */
 		int nparam = sq_gettop(vm);
 		SQUserPointer ptr = nullptr;
@@ -817,6 +821,8 @@ namespace SQConvert {
 	template <typename Tcls, typename Tmethod>
 	inline SQInteger DefSQStaticCallback(HSQUIRRELVM vm)
 	{
+		SquirrelAPIScope api_scope;
+
 		/* Find the amount of params we got */
 		int nparam = sq_gettop(vm);
 		SQUserPointer ptr = nullptr;
@@ -841,6 +847,8 @@ namespace SQConvert {
 	template <typename Tcls, typename Tmethod>
 	inline SQInteger DefSQAdvancedStaticCallback(HSQUIRRELVM vm)
 	{
+		SquirrelAPIScope api_scope;
+
 		/* Find the amount of params we got */
 		int nparam = sq_gettop(vm);
 		SQUserPointer ptr = nullptr;
@@ -861,6 +869,8 @@ namespace SQConvert {
 	template <typename Tcls>
 	static SQInteger DefSQDestructorCallback(SQUserPointer p, SQInteger size)
 	{
+		SquirrelAPIScope api_scope;
+
 		/* Remove the real instance too */
 		if (p != nullptr) ((Tcls *)p)->Release();
 		return 0;
@@ -874,6 +884,8 @@ namespace SQConvert {
 	template <typename Tcls, typename Tmethod, int Tnparam>
 	inline SQInteger DefSQConstructorCallback(HSQUIRRELVM vm)
 	{
+		SquirrelAPIScope api_scope;
+
 		try {
 			/* Create the real instance */
 			Tcls *instance = HelperT<Tmethod>::SQConstruct((Tcls *)nullptr, (Tmethod)nullptr, vm);
@@ -893,6 +905,8 @@ namespace SQConvert {
 	template <typename Tcls>
 	inline SQInteger DefSQAdvancedConstructorCallback(HSQUIRRELVM vm)
 	{
+		SquirrelAPIScope api_scope;
+
 		try {
 			/* Find the amount of params we got */
 			int nparam = sq_gettop(vm);
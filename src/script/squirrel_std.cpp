@@ -43,6 +43,8 @@ SQInteger SquirrelStd::max(HSQUIRRELVM vm)
 
 SQInteger SquirrelStd::require(HSQUIRRELVM vm)
 {
+	SquirrelAPIScope api_scope;
+
 	SQInteger top = sq_gettop(vm);
 	const SQChar *filename;
 
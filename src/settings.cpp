@@ -2031,6 +2031,7 @@ CommandCost CmdChangeSetting(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 			GamelogStopAction();
 		}
 
+		InvalidateFormattedStringCaches();
 		SetWindowClassesDirty(WC_GAME_OPTIONS);
 	}
 
@@ -2100,6 +2101,7 @@ bool SetSettingValue(uint index, int32 value, bool force_newgame)
 		}
 		if (sd->desc.proc != nullptr) sd->desc.proc((int32)ReadValue(var, sd->save.conv));
 
+		InvalidateFormattedStringCaches();
 		SetWindowClassesDirty(WC_GAME_OPTIONS);
 
 		return true;
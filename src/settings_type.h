@@ -125,6 +125,8 @@ struct GUISettings {
 	uint8  scrollwheel_multiplier;           ///< how much 'wheel' per incoming event from the OS?
 	bool   viewport_map_scan_surroundings;   ///< look for the most important tile in surroundings
 	bool   show_slopes_on_viewport_map;      ///< use slope orientation to render the ground
+	bool   cache_tile_sprites;               ///< reuse the sprites of unchanged tiles when redrawing viewports
+	bool   dirty_rect_tracking;              ///< track areas to redraw as a list of rectangles instead of fixed size blocks
 	uint32 default_viewport_map_mode;        ///< the mode to use by default when a viewport is in map mode, 0=owner, 1=industry, 2=vegetation
 	uint32 action_when_viewport_map_is_dblclicked; ///< what to do when a doubleclick occurs on the viewport map
 	uint32 show_scrolling_viewport_on_map;   ///< when a no map viewport is scrolled, its location is marked on the other map viewports
@@ -404,6 +406,8 @@ struct AISettings {
 struct ScriptSettings {
 	uint8  settings_profile;                 ///< difficulty profile to set initial settings of scripts, esp. random AIs
 	uint32 script_max_opcode_till_suspend;   ///< max opcode calls till scripts will suspend
+	bool   script_worker_threads;            ///< run AI scripts on worker threads
+	uint16 script_gc_budget;                 ///< time per tick a script may spend in incremental garbage collection, in microseconds; 0 for a full collection at once
 };
 
 /** Settings related to the new pathfinder. */
@@ -576,6 +580,7 @@ struct EconomySettings {
 	bool   allow_town_level_crossings;       ///< towns are allowed to build level crossings
 	int8   old_town_cargo_factor;            ///< old power-of-two multiplier for town (passenger, mail) generation. May be negative.
 	int16  town_cargo_scale_factor;          ///< scaled power-of-two multiplier for town (passenger, mail) generation. May be negative.
+	bool   town_cargo_batching;              ///< move town cargo to stations once per tick for each town, cargo and pair of stations instead of once per house
 	bool   infrastructure_maintenance;       ///< enable monthly maintenance fee for owner infrastructure
 	uint8  day_length_factor;                ///< factor which the length of day is multiplied
 	uint16 random_road_reconstruction;       ///< chance out of 1000 per tile loop for towns to start random road re-construction
@@ -211,6 +211,16 @@ public:
 		return false;
 	}
 
+	/**
+	 * Check if the list will be sorted by the next Sort call
+	 *
+	 * @return true if the list will be sorted
+	 */
+	bool WillResort() const
+	{
+		return (this->flags & VL_RESORT) && this->IsSortable();
+	}
+
 	/**
 	 * Force a resort next Sort call
 	 *  Reset the resort timer if used too.
@@ -541,6 +541,16 @@ size_t GetGRFSpriteOffset(uint32 id)
 	return iter != _grf_sprite_offsets.end() ? iter->second : SIZE_MAX;
 }
 
+/**
+ * Set the sprite section offsets of the current GRF from an index built earlier.
+ * @param offsets Sprite IDs and their positions in the sprite section, in file order.
+ */
+void SetGRFSpriteOffsets(const std::vector<std::pair<uint32, size_t>> &offsets)
+{
+	_grf_sprite_offsets.clear();
+	for (const auto &offset : offsets) _grf_sprite_offsets[offset.first] = offset.second;
+}
+
 /**
  * Parse the sprite section of GRFs.
  * @param container_version Container version of the GRF we're currently processing.
@@ -14,6 +14,8 @@
 
 #include "gfx_type.h"
 
+#include <vector>
+
 /** Data structure describing a sprite. */
 struct Sprite {
 	uint16 height; ///< Height of the sprite.
@@ -53,6 +55,7 @@ void GfxClearSpriteCache();
 void IncreaseSpriteLRU();
 
 void ReadGRFSpriteOffsets(byte container_version);
+void SetGRFSpriteOffsets(const std::vector<std::pair<uint32, size_t>> &offsets);
 size_t GetGRFSpriteOffset(uint32 id);
 bool LoadNextSprite(int load_index, uint file_index, uint file_sprite_id, byte container_version);
 bool SkipSpriteData(byte type, uint16 num);
@@ -40,6 +40,9 @@
 StationPool _station_pool("Station");
 INSTANTIATE_POOL_METHODS(Station)
 
+/** The stations covering each tile with their catchment area. */
+StationCatchmentIndex _station_catchment_index;
+
 
 StationKdtree _station_kdtree(Kdtree_StationXYFunc);
 
@@ -77,7 +80,8 @@ Station::Station(TileIndex tile) :
 	dock_station(INVALID_TILE, 0, 0),
 	indtype(IT_INVALID),
 	time_since_load(255),
-	time_since_unload(255)
+	time_since_unload(255),
+	rating_cargoes(ALL_CARGOTYPES)
 {
 	/* this->random_bits is set in Station::AddFacility() */
 }
@@ -95,6 +99,7 @@ Station::~Station()
 		for (CargoID c = 0; c < NUM_CARGO; c++) {
 			this->goods[c].cargo.OnCleanPool();
 		}
+		_station_catchment_index.clear();
 		return;
 	}
 
@@ -140,6 +145,7 @@ Station::~Station()
 
 	/* Remove station from industries and towns that reference it. */
 	this->RemoveFromAllNearbyLists();
+	this->UpdateCatchmentIndex(false);
 
 	/* Clear the persistent storage. */
 	delete this->airport.psa;
@@ -431,14 +437,32 @@ bool Station::CatchmentCoversTown(TownID t) const
 	return false;
 }
 
+/**
+ * Add the tiles of our catchment area to the catchment index or remove them from it.
+ * @param add True to add the tiles, false to remove them.
+ */
+void Station::UpdateCatchmentIndex(bool add) const
+{
+	BitmapTileIterator it(this->catchment_tiles);
+	for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
+		if (add) {
+			_station_catchment_index.insert(StationCatchmentIndexKey(tile, this->index));
+		} else {
+			_station_catchment_index.erase(StationCatchmentIndexKey(tile, this->index));
+		}
+	}
+}
+
 /**
  * Recompute tiles covered in our catchment area.
- * This will additionally recompute nearby towns and industries.
+ * This will additionally recompute nearby towns and industries and update
+ * the catchment index.
  */
 void Station::RecomputeCatchment()
 {
 	this->industries_near.clear();
 	this->RemoveFromAllNearbyLists();
+	this->UpdateCatchmentIndex(false);
 
 	if (this->rect.IsEmpty()) {
 		this->catchment_tiles.Reset();
@@ -460,6 +484,7 @@ void Station::RecomputeCatchment()
 		this->industry->stations_near.clear();
 		this->industry->stations_near.insert(this);
 		this->industries_near.insert(this->industry);
+		this->UpdateCatchmentIndex(true);
 		return;
 	}
 
@@ -478,6 +503,8 @@ void Station::RecomputeCatchment()
 		TILE_AREA_LOOP(tile2, ta2) this->catchment_tiles.SetTile(tile2);
 	}
 
+	this->UpdateCatchmentIndex(true);
+
 	/* Search catchment tiles for towns and industries */
 	BitmapTileIterator it(this->catchment_tiles);
 	for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
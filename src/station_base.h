@@ -22,6 +22,7 @@
 #include "3rdparty/cpp-btree/btree_map.h"
 #include "3rdparty/cpp-btree/btree_set.h"
 #include "bitmap_type.h"
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -30,16 +31,131 @@ extern StationPool _station_pool;
 
 static const byte INITIAL_STATION_RATING = 175;
 
+/**
+ * Flat map of flow shares, sorted by the cumulative flow. Most flows are only
+ * sent via a handful of stations, so that many entries are stored inline and
+ * only bigger maps need an allocation. The interface is the part of std::map
+ * that is used for flow shares.
+ */
+class FlowShareMap {
+public:
+	typedef std::pair<uint32, StationID> value_type;
+	typedef value_type *iterator;
+	typedef const value_type *const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	static const uint INLINE_SIZE = 8; ///< Number of entries stored without an allocation.
+
+	inline FlowShareMap() : data(this->inline_data), count(0), capacity(INLINE_SIZE) {}
+
+	inline FlowShareMap(const FlowShareMap &other) : data(this->inline_data), count(0), capacity(INLINE_SIZE)
+	{
+		*this = other;
+	}
+
+	inline FlowShareMap(FlowShareMap &&other) : data(this->inline_data), count(0), capacity(INLINE_SIZE)
+	{
+		*this = std::move(other);
+	}
+
+	inline ~FlowShareMap()
+	{
+		if (this->data != this->inline_data) delete[] this->data;
+	}
+
+	FlowShareMap &operator=(const FlowShareMap &other);
+	FlowShareMap &operator=(FlowShareMap &&other);
+
+	/**
+	 * Swap the contents of this map with another one.
+	 * @param other Map to swap with.
+	 */
+	inline void swap(FlowShareMap &other)
+	{
+		FlowShareMap tmp(std::move(other));
+		other = std::move(*this);
+		*this = std::move(tmp);
+	}
+
+	inline iterator begin() { return this->data; }
+	inline const_iterator begin() const { return this->data; }
+	inline iterator end() { return this->data + this->count; }
+	inline const_iterator end() const { return this->data + this->count; }
+	inline reverse_iterator rbegin() { return reverse_iterator(this->end()); }
+	inline const_reverse_iterator rbegin() const { return const_reverse_iterator(this->end()); }
+	inline reverse_iterator rend() { return reverse_iterator(this->begin()); }
+	inline const_reverse_iterator rend() const { return const_reverse_iterator(this->begin()); }
+
+	inline bool empty() const { return this->count == 0; }
+	inline size_t size() const { return this->count; }
+
+	/**
+	 * Get the entry with the highest key, i.e. the sum of all shares.
+	 * @return Last entry.
+	 */
+	inline const value_type &back() const
+	{
+		assert(this->count > 0);
+		return this->data[this->count - 1];
+	}
+
+	/**
+	 * Find the first entry with a key greater than the given one. Small maps
+	 * are scanned linearly, as that is faster than a binary search for them.
+	 * @param key Key to look for.
+	 * @return Iterator to the entry or end() if there is none.
+	 */
+	inline const_iterator upper_bound(uint32 key) const
+	{
+		const_iterator it = this->begin();
+		const_iterator last = this->end();
+		if (this->count > INLINE_SIZE) {
+			return std::upper_bound(it, last, key, [](uint32 k, const value_type &v) { return k < v.first; });
+		}
+		while (it != last && it->first <= key) ++it;
+		return it;
+	}
+
+	inline iterator upper_bound(uint32 key)
+	{
+		return const_cast<iterator>(const_cast<const FlowShareMap *>(this)->upper_bound(key));
+	}
+
+	/**
+	 * Get the station for a key, inserting an entry if there is none yet.
+	 * Keys are usually added in ascending order, so appending is fast.
+	 * @param key Key of the entry.
+	 * @return Reference to the station of the entry.
+	 */
+	inline StationID &operator[](uint32 key)
+	{
+		if (this->count > 0 && this->data[this->count - 1].first >= key) return this->Insert(key);
+		if (this->count == this->capacity) this->Grow(this->count + 1);
+		this->data[this->count] = value_type(key, StationID());
+		return this->data[this->count++].second;
+	}
+
+private:
+	value_type *data;                      ///< Entries, either inline_data or allocated.
+	uint count;                            ///< Number of entries.
+	uint capacity;                         ///< Number of entries data has space for.
+	value_type inline_data[INLINE_SIZE];   ///< Inline storage for small maps.
+
+	StationID &Insert(uint32 key);
+	void Grow(uint size);
+};
+
 /**
  * Flow statistics telling how much flow should be sent along a link. This is
- * done by creating "flow shares" and using std::map's upper_bound() method to
- * look them up with a random number. A flow share is the difference between a
+ * done by creating "flow shares" and using the shares map's upper_bound()
+ * method to look them up with a random number. A flow share is the difference between a
  * key in a map and the previous key. So one key in the map doesn't actually
  * mean anything by itself.
  */
 class FlowStat {
 public:
-	typedef btree::btree_map<uint32, StationID> SharesMap;
+	typedef FlowShareMap SharesMap;
 
 	static const SharesMap empty_sharesmap;
 
@@ -74,7 +190,7 @@ public:
 	inline void AppendShare(StationID st, uint flow, bool restricted = false)
 	{
 		assert(flow > 0);
-		this->shares[(--this->shares.end())->first + flow] = st;
+		this->shares[this->shares.back().first + flow] = st;
 		if (!restricted) this->unrestricted += flow;
 	}
 
@@ -123,7 +239,7 @@ public:
 	inline StationID GetViaWithRestricted(bool &is_restricted) const
 	{
 		assert(!this->shares.empty());
-		uint rand = RandomRange((--this->shares.end())->first);
+		uint rand = RandomRange(this->shares.back().first);
 		is_restricted = rand >= this->unrestricted;
 		return this->shares.upper_bound(rand)->second;
 	}
@@ -484,6 +600,7 @@ public:
 	std::vector<Vehicle *> loading_vehicles;
 	GoodsEntry goods[NUM_CARGO];  ///< Goods at this station
 	CargoTypes always_accepted;       ///< Bitmask of always accepted cargo types (by houses, HQs, industry tiles when industry doesn't accept cargo)
+	CargoTypes rating_cargoes;        ///< NOSAVE: Cargo types which may need a rating update. Superset of those with a rating or with a rating below INITIAL_STATION_RATING.
 
 	IndustryList industries_near; ///< Cached list of industries near the station that can accept cargo, @see DeliverGoodsToIndustry()
 	Industry *industry;           ///< NOSAVE: Associated industry for neutral stations. (Rebuilt on load from Industry->st)
@@ -517,6 +634,7 @@ public:
 
 	bool CatchmentCoversTown(TownID t) const;
 	void RemoveFromAllNearbyLists();
+	void UpdateCatchmentIndex(bool add) const;
 
 	inline bool TileIsInCatchment(TileIndex tile) const
 	{
@@ -543,6 +661,40 @@ public:
 
 #define FOR_ALL_STATIONS(var) FOR_ALL_BASE_STATIONS_OF_TYPE(Station, var)
 
+/**
+ * Index of the stations whose catchment area covers a tile. Each entry is a
+ * key made by StationCatchmentIndexKey, so the stations covering a tile are
+ * adjacent and ordered by their index.
+ */
+typedef btree::btree_set<uint64> StationCatchmentIndex;
+extern StationCatchmentIndex _station_catchment_index;
+
+/**
+ * Make the key of a tile covered by a station's catchment area.
+ * @param tile Covered tile.
+ * @param station Covering station.
+ * @return Key for the catchment index.
+ */
+static inline uint64 StationCatchmentIndexKey(TileIndex tile, StationID station)
+{
+	return ((uint64)tile << 16) | station;
+}
+
+/**
+ * Call a function for all stations whose catchment area covers a tile, in
+ * order of their index.
+ * @param tile Tile to look up.
+ * @param func Function to call with each station.
+ */
+template <typename Func>
+void ForAllStationsCoveringTile(TileIndex tile, Func func)
+{
+	StationCatchmentIndex::const_iterator it = _station_catchment_index.lower_bound(StationCatchmentIndexKey(tile, 0));
+	for (; it != _station_catchment_index.end() && (TileIndex)(*it >> 16) == tile; ++it) {
+		func(Station::Get((StationID)GB(*it, 0, 16)));
+	}
+}
+
 /** Iterator to iterate over all tiles belonging to an airport. */
 class AirportTileIterator : public OrthogonalTileIterator {
 private:
@@ -3552,9 +3552,18 @@ static void UpdateStationRating(Station *st)
 	byte_inc_sat(&st->time_since_load);
 	byte_inc_sat(&st->time_since_unload);
 
-	const CargoSpec *cs;
-	FOR_ALL_CARGOSPECS(cs) {
-		GoodsEntry *ge = &st->goods[cs->Index()];
+	CargoID c;
+	FOR_EACH_SET_CARGO_ID(c, st->rating_cargoes) {
+		const CargoSpec *cs = CargoSpec::Get(c);
+		if (!cs->IsValid()) continue;
+
+		GoodsEntry *ge = &st->goods[c];
+		if (!ge->HasRating() && ge->rating >= INITIAL_STATION_RATING) {
+			/* Nothing to do until the cargo gets a rating or its rating is lowered. */
+			ClrBit(st->rating_cargoes, c);
+			continue;
+		}
+
 		/* Slowly increase the rating back to his original level in the case we
 		 *  didn't deliver cargo yet to this station. This happens when a bribe
 		 *  failed while you didn't moved that cargo yet to a station. */
@@ -3942,6 +3951,7 @@ void ModifyStationRatingAround(TileIndex tile, Owner owner, int amount, uint rad
 
 				if (ge->status != 0) {
 					ge->rating = Clamp(ge->rating + amount, 0, 255);
+					SetBit(st->rating_cargoes, i);
 				}
 			}
 		}
@@ -3982,6 +3992,7 @@ static uint UpdateStationWaiting(Station *st, CargoID type, uint amount, SourceT
 	if (!ge.HasRating()) {
 		InvalidateWindowData(WC_STATION_LIST, st->index);
 		SetBit(ge.status, GoodsEntry::GES_RATING);
+		SetBit(st->rating_cargoes, type);
 	}
 
 	TriggerStationRandomisation(st, st->xy, SRT_NEW_CARGO, type);
@@ -4042,9 +4053,9 @@ CommandCost CmdRenameStation(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 
 static void AddNearbyStationsByCatchment(TileIndex tile, StationList *stations, StationList &nearby)
 {
-	for (Station *st : nearby) {
-		if (st->TileIsInCatchment(tile)) stations->insert(st);
-	}
+	ForAllStationsCoveringTile(tile, [&](Station *st) {
+		if (nearby.find(st) != nearby.end()) stations->insert(st);
+	});
 }
 
 /**
@@ -4070,33 +4081,15 @@ void FindStationsAroundTiles(const TileArea &location, StationList * const stati
 		}
 	}
 
-	/* Not using, or don't have a nearby stations list, so we need to scan. */
-
-	btree::btree_set<StationID> seen_stations;
-
-	/* Scan an area around the building covering the maximum possible station
-	 * to find the possible nearby stations. */
-	uint max_c = _settings_game.station.modified_catchment ? MAX_CATCHMENT : CA_UNMODIFIED;
-	max_c += _settings_game.station.catchment_increase;
-	TileArea ta = TileArea(location).Expand(max_c);
-	TILE_AREA_LOOP(tile, ta) {
-		if (IsTileType(tile, MP_STATION)) seen_stations.insert(GetStationIndex(tile));
-	}
-
-	for (StationID stationid : seen_stations) {
-		Station *st = Station::GetIfValid(stationid);
-		if (st == nullptr) continue; /* Waypoint */
+	/* Not using, or don't have a nearby stations list, so we need to look up
+	 * the stations covering the tiles in the catchment index. */
+	TILE_AREA_LOOP(tile, location) {
+		ForAllStationsCoveringTile(tile, [&](Station *st) {
+			/* Check if station is attached to an industry */
+			if (!_settings_game.station.serve_neutral_industries && st->industry != nullptr) return;
 
-		/* Check if station is attached to an industry */
-		if (!_settings_game.station.serve_neutral_industries && st->industry != nullptr) continue;
-
-		/* Test if the tile is within the station's catchment */
-		TILE_AREA_LOOP(tile, location) {
-			if (st->TileIsInCatchment(tile)) {
-				stations->insert(st);
-				break;
-			}
-		}
+			stations->insert(st);
+		});
 	}
 }
 
@@ -4113,41 +4106,66 @@ const StationList *StationFinder::GetStations()
 	return &this->stations;
 }
 
-uint MoveGoodsToStation(CargoID type, uint amount, SourceType source_type, SourceID source_id, const StationList *all_stations)
+/**
+ * Select the two stations with the best rating for a cargo that may receive it.
+ * @param type Type of the cargo.
+ * @param all_stations Stations to select from.
+ * @param[out] st1 Station with the best rating, or nullptr if there is none.
+ * @param[out] st2 Station with the second best rating, or nullptr if there is none.
+ */
+void SelectStationsForGoods(CargoID type, const StationList *all_stations, Station **st1, Station **st2)
 {
-	/* Return if nothing to do. Also the rounding below fails for 0. */
-	if (amount == 0) return 0;
-
-	Station *st1 = nullptr;   // Station with best rating
-	Station *st2 = nullptr;   // Second best station
+	*st1 = nullptr;        // Station with best rating
+	*st2 = nullptr;        // Second best station
 	uint best_rating1 = 0; // rating of st1
 	uint best_rating2 = 0; // rating of st2
 
+	/* Passengers are never served by just a truck stop, other cargoes never by just a bus stop. */
+	const StationFacility unusable_facilities = IsCargoInClass(type, CC_PASSENGERS) ? FACIL_TRUCK_STOP : FACIL_BUS_STOP;
+	const bool selectgoods = _settings_game.order.selectgoods;
+
 	for (Station *st : *all_stations) {
-		/* Is the station reserved exclusively for somebody else? */
-		if (st->owner != OWNER_NONE && st->town->exclusive_counter > 0 && st->town->exclusivity != st->owner) continue;
+		const GoodsEntry &ge = st->goods[type];
 
-		if (st->goods[type].rating == 0) continue; // Lowest possible rating, better not to give cargo anymore
+		/* Check the station's own state first, it is cheaper than looking at its town. */
+		if (ge.rating == 0) continue; // Lowest possible rating, better not to give cargo anymore
 
-		if (_settings_game.order.selectgoods && !st->goods[type].HasVehicleEverTriedLoading()) continue; // Selectively servicing stations, and not this one
+		if (selectgoods && !ge.HasVehicleEverTriedLoading()) continue; // Selectively servicing stations, and not this one
 
-		if (IsCargoInClass(type, CC_PASSENGERS)) {
-			if (st->facilities == FACIL_TRUCK_STOP) continue; // passengers are never served by just a truck stop
-		} else {
-			if (st->facilities == FACIL_BUS_STOP) continue; // non-passengers are never served by just a bus stop
-		}
+		if (st->facilities == unusable_facilities) continue;
+
+		/* Is the station reserved exclusively for somebody else? */
+		if (st->owner != OWNER_NONE && st->town->exclusive_counter > 0 && st->town->exclusivity != st->owner) continue;
 
 		/* This station can be used, add it to st1/st2 */
-		if (st1 == nullptr || st->goods[type].rating >= best_rating1) {
-			st2 = st1; best_rating2 = best_rating1; st1 = st; best_rating1 = st->goods[type].rating;
-		} else if (st2 == nullptr || st->goods[type].rating >= best_rating2) {
-			st2 = st; best_rating2 = st->goods[type].rating;
+		if (*st1 == nullptr || ge.rating >= best_rating1) {
+			*st2 = *st1; best_rating2 = best_rating1; *st1 = st; best_rating1 = ge.rating;
+		} else if (*st2 == nullptr || ge.rating >= best_rating2) {
+			*st2 = st; best_rating2 = ge.rating;
 		}
 	}
+}
+
+/**
+ * Move goods to the stations selected by SelectStationsForGoods, split by their ratings.
+ * @param type Type of the cargo.
+ * @param amount Amount of cargo.
+ * @param source_type Type of the source of the cargo.
+ * @param source_id ID of the source of the cargo.
+ * @param st1 Station with the best rating, or nullptr if there is none.
+ * @param st2 Station with the second best rating, or nullptr if there is none.
+ * @return Amount of cargo moved to the stations.
+ */
+uint MoveGoodsToSelectedStations(CargoID type, uint amount, SourceType source_type, SourceID source_id, Station *st1, Station *st2)
+{
+	/* Return if nothing to do. Also the rounding below fails for 0. */
+	if (amount == 0) return 0;
 
 	/* no stations around at all? */
 	if (st1 == nullptr) return 0;
 
+	uint best_rating1 = st1->goods[type].rating;
+
 	/* From now we'll calculate with fractal cargo amounts.
 	 * First determine how much cargo we really have. */
 	amount *= best_rating1 + 1;
@@ -4157,9 +4175,9 @@ uint MoveGoodsToStation(CargoID type, uint amount, SourceType source_type, Sourc
 		return UpdateStationWaiting(st1, type, amount, source_type, source_id);
 	}
 
+	uint best_rating2 = st2->goods[type].rating;
+
 	/* several stations around, the best two (highest rating) are in st1 and st2 */
-	assert(st1 != nullptr);
-	assert(st2 != nullptr);
 	assert(best_rating1 != 0 || best_rating2 != 0);
 
 	/* Then determine the amount the worst station gets. We do it this way as the
@@ -4177,6 +4195,16 @@ uint MoveGoodsToStation(CargoID type, uint amount, SourceType source_type, Sourc
 	return moved + UpdateStationWaiting(st2, type, worst_cargo, source_type, source_id);
 }
 
+uint MoveGoodsToStation(CargoID type, uint amount, SourceType source_type, SourceID source_id, const StationList *all_stations)
+{
+	/* Return if nothing to do. */
+	if (amount == 0) return 0;
+
+	Station *st1, *st2;
+	SelectStationsForGoods(type, all_stations, &st1, &st2);
+	return MoveGoodsToSelectedStations(type, amount, source_type, source_id, st1, st2);
+}
+
 void BuildOilRig(TileIndex tile)
 {
 	if (!Station::CanAllocateItem()) {
@@ -4436,6 +4464,78 @@ static CommandCost TerraformTile_Station(TileIndex tile, DoCommandFlag flags, in
 	return DoCommand(tile, 0, 0, flags, CMD_LANDSCAPE_CLEAR);
 }
 
+/**
+ * Copy the entries of another map into this one.
+ * @param other Map to copy.
+ * @return This map.
+ */
+FlowShareMap &FlowShareMap::operator=(const FlowShareMap &other)
+{
+	if (this == &other) return *this;
+	this->count = 0;
+	if (other.count > this->capacity) this->Grow(other.count);
+	std::copy(other.begin(), other.end(), this->data);
+	this->count = other.count;
+	return *this;
+}
+
+/**
+ * Move the entries of another map into this one, taking over its allocation
+ * if it has one.
+ * @param other Map to move from, empty afterwards.
+ * @return This map.
+ */
+FlowShareMap &FlowShareMap::operator=(FlowShareMap &&other)
+{
+	if (this == &other) return *this;
+	if (other.data == other.inline_data) {
+		*this = const_cast<const FlowShareMap &>(other);
+	} else {
+		if (this->data != this->inline_data) delete[] this->data;
+		this->data = other.data;
+		this->count = other.count;
+		this->capacity = other.capacity;
+		other.data = other.inline_data;
+		other.capacity = INLINE_SIZE;
+	}
+	other.count = 0;
+	return *this;
+}
+
+/**
+ * Get the station for a key that is not greater than the last key, inserting
+ * an entry at the right place if there is none yet.
+ * @param key Key of the entry.
+ * @return Reference to the station of the entry.
+ */
+StationID &FlowShareMap::Insert(uint32 key)
+{
+	iterator it = std::lower_bound(this->begin(), this->end(), key, [](const value_type &v, uint32 k) { return v.first < k; });
+	if (it != this->end() && it->first == key) return it->second;
+
+	size_t pos = it - this->begin();
+	if (this->count == this->capacity) this->Grow(this->count + 1);
+	std::copy_backward(this->data + pos, this->data + this->count, this->data + this->count + 1);
+	this->data[pos] = value_type(key, StationID());
+	this->count++;
+	return this->data[pos].second;
+}
+
+/**
+ * Make space for at least the given number of entries, keeping the current ones.
+ * @param size Number of entries needed.
+ */
+void FlowShareMap::Grow(uint size)
+{
+	if (size <= this->capacity) return;
+	uint new_capacity = max(size, this->capacity * 2);
+	value_type *new_data = new value_type[new_capacity];
+	std::copy(this->begin(), this->end(), new_data);
+	if (this->data != this->inline_data) delete[] this->data;
+	this->data = new_data;
+	this->capacity = new_capacity;
+}
+
 /**
  * Get flow for a station.
  * @param st Station to get flow for.
@@ -4523,7 +4623,7 @@ void FlowStat::Invalidate()
 		if (it->first == this->unrestricted) this->unrestricted = i;
 	}
 	this->shares.swap(new_shares);
-	assert(!this->shares.empty() && this->unrestricted <= (--this->shares.end())->first);
+	assert(!this->shares.empty() && this->unrestricted <= this->shares.back().first);
 }
 
 /**
@@ -4777,7 +4877,7 @@ uint FlowStatMap::GetFlow() const
 {
 	uint ret = 0;
 	for (FlowStatMap::const_iterator i = this->begin(); i != this->end(); ++i) {
-		ret += (--(i->second.GetShares()->end()))->first;
+		ret += i->second.GetShares()->back().first;
 	}
 	return ret;
 }
@@ -4805,7 +4905,7 @@ uint FlowStatMap::GetFlowFrom(StationID from) const
 {
 	FlowStatMap::const_iterator i = this->find(from);
 	if (i == this->end()) return 0;
-	return (--(i->second.GetShares()->end()))->first;
+	return i->second.GetShares()->back().first;
 }
 
 /**
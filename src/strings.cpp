@@ -2074,6 +2074,8 @@ bool ReadLanguagePack(const LanguageMetadata *lang)
 	}
 #endif /* WITH_ICU_I18N */
 
+	InvalidateFormattedStringCaches();
+
 	/* Some lists need to be sorted again after a language change. */
 	ReconsiderGameScriptLanguage();
 	InitializeSortedCargoSpecs();
@@ -2135,6 +2137,72 @@ bool StringIDSorter(const StringID &a, const StringID &b)
 	return strnatcmp(stra, strb) < 0;
 }
 
+/** Generation of the formatted string caches; a cache of an older generation is out of date. */
+static uint32 _formatted_string_cache_generation = 0;
+
+/**
+ * Mark the contents of all formatted string caches as out of date.
+ * Call this when the formatting of a string with the same parameters
+ * may give a different result, e.g. after a language or currency change.
+ */
+void InvalidateFormattedStringCaches()
+{
+	_formatted_string_cache_generation++;
+}
+
+bool FormattedStringCache::Key::operator==(const Key &other) const
+{
+	if (this->string != other.string || this->num_params != other.num_params) return false;
+	for (uint i = 0; i < this->num_params; i++) {
+		if (this->params[i] != other.params[i]) return false;
+	}
+	return true;
+}
+
+size_t FormattedStringCache::KeyHash::operator()(const Key &key) const
+{
+	size_t hash = std::hash<uint32>()(key.string);
+	for (uint i = 0; i < key.num_params; i++) {
+		hash = hash * 31 + std::hash<uint64>()(key.params[i]);
+	}
+	return hash;
+}
+
+/**
+ * Get a string formatted with the current string parameters, from the cache
+ * when it was formatted with the same parameters before.
+ * @param string The string to format.
+ * @param num_params The number of string parameters used by the string.
+ * @return The formatted string; it stays valid until the cache is emptied.
+ */
+const char *FormattedStringCache::GetString(StringID string, uint num_params)
+{
+	assert(num_params <= MAX_PARAMS);
+
+	if (this->generation != _formatted_string_cache_generation || this->strings.size() >= MAX_STRINGS) this->Clear();
+
+	Key key;
+	key.string = string;
+	key.num_params = num_params;
+	for (uint i = 0; i < num_params; i++) key.params[i] = GetDParam(i);
+
+	auto it = this->strings.find(key);
+	if (it != this->strings.end()) return it->second.c_str();
+
+	char buffer[DRAW_STRING_BUFFER];
+	::GetString(buffer, string, lastof(buffer));
+	return this->strings.emplace(key, buffer).first->second.c_str();
+}
+
+/**
+ * Empty the cache.
+ */
+void FormattedStringCache::Clear()
+{
+	this->strings.clear();
+	this->generation = _formatted_string_cache_generation;
+}
+
 /**
  * Get the language with the given NewGRF language ID.
  * @param newgrflangid NewGRF languages ID to check.
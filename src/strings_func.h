@@ -16,6 +16,8 @@
 #include "string_type.h"
 #include "gfx_type.h"
 #include "core/bitmath_func.hpp"
+#include <string>
+#include <unordered_map>
 
 /**
  * Extract the StringTab from a StringID.
@@ -242,6 +244,44 @@ const char *GetCurrentLanguageIsoCode();
 
 bool StringIDSorter(const StringID &a, const StringID &b);
 
+void InvalidateFormattedStringCaches();
+
+/**
+ * Cache of strings formatted with the current string parameters, for windows
+ * that format the same strings for many rows on every redraw.
+ * The cache only looks at the values of the parameters, so it must not be used
+ * for strings that get a raw string (SetDParamStr) as parameter.
+ * All caches are emptied when the language, a setting or the names of things
+ * change (see InvalidateFormattedStringCaches); windows should empty their cache
+ * themselves when the data shown by their strings changes in any other way.
+ */
+class FormattedStringCache {
+public:
+	static const uint MAX_PARAMS = 8;     ///< Maximum number of parameters of a cached string.
+	static const size_t MAX_STRINGS = 4096; ///< Maximum number of cached strings, the cache is emptied when it gets larger.
+
+	const char *GetString(StringID string, uint num_params);
+	void Clear();
+
+private:
+	/** The string and the parameters it was formatted with. */
+	struct Key {
+		StringID string;
+		uint num_params;
+		uint64 params[MAX_PARAMS];
+
+		bool operator==(const Key &other) const;
+	};
+
+	/** Hash of a Key. */
+	struct KeyHash {
+		size_t operator()(const Key &key) const;
+	};
+
+	std::unordered_map<Key, std::string, KeyHash> strings; ///< The formatted strings.
+	uint32 generation = 0;                                  ///< Value of the global generation counter when the cache was last emptied.
+};
+
 /**
  * A searcher for missing glyphs.
  */
@@ -17,6 +17,6 @@
 
 void ShowTimetableWindow(const Vehicle *v);
 void UpdateVehicleTimetable(Vehicle *v, bool travelling);
-void SetTimetableParams(int first_param, Ticks ticks);
+uint SetTimetableParams(int first_param, Ticks ticks);
 
 #endif /* TIMETABLE_H */
@@ -45,12 +45,14 @@ struct TimetableArrivalDeparture {
  * Set the timetable parameters in the format as described by the setting.
  * @param param the first DParam to fill
  * @param ticks  the number of ticks to 'draw'
+ * @return the number of DParams filled
  */
-void SetTimetableParams(int first_param, Ticks ticks)
+uint SetTimetableParams(int first_param, Ticks ticks)
 {
 	if (_settings_client.gui.timetable_in_ticks) {
 		SetDParam(first_param, STR_TIMETABLE_TICKS);
 		SetDParam(first_param + 1, ticks);
+		return 2;
 	} else {
 		StringID str = _settings_client.gui.time_in_minutes ? STR_TIMETABLE_MINUTES : STR_TIMETABLE_DAYS;
 		size_t ratio = DATE_UNIT_SIZE;
@@ -61,9 +63,11 @@ void SetTimetableParams(int first_param, Ticks ticks)
 			SetDParam(first_param + 1, str);
 			SetDParam(first_param + 2, units);
 			SetDParam(first_param + 3, leftover);
+			return 4;
 		} else {
 			SetDParam(first_param, str);
 			SetDParam(first_param + 1, units);
+			return 2;
 		}
 	}
 }
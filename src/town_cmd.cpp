@@ -54,6 +54,7 @@
 #include "zoom_func.h"
 #include "zoning.h"
 #include "scope.h"
+#include "3rdparty/cpp-btree/btree_map.h"
 
 #include "table/strings.h"
 #include "table/town_land.h"
@@ -620,6 +621,26 @@ static void MakeTownHouseBigger(TileIndex tile)
 	if (flags & BUILDING_HAS_4_TILES) MakeSingleHouseBigger(TILE_ADDXY(tile, 1, 1));
 }
 
+/**
+ * Town cargo generated during the tile loop which has not been moved to the
+ * stations yet, when town_cargo_batching is enabled. It is moved at the start
+ * of OnTick_Town in the same tick, see MoveBatchedTownCargo.
+ */
+static btree::btree_map<uint64, uint> _town_cargo_batch;
+
+/**
+ * Make the key of batched town cargo.
+ * @param town Town which generated the cargo.
+ * @param ct Type of the cargo.
+ * @param st1 Station with the best rating for the cargo.
+ * @param st2 Station with the second best rating for the cargo or INVALID_STATION.
+ * @return Key for _town_cargo_batch.
+ */
+static inline uint64 TownCargoBatchKey(TownID town, CargoID ct, StationID st1, StationID st2)
+{
+	return ((uint64)town << 48) | ((uint64)ct << 32) | ((uint64)st1 << 16) | st2;
+}
+
 /**
  * Generate cargo for a town (house).
  *
@@ -668,6 +689,19 @@ static void TownGenerateCargo (Town *t, CargoID ct, uint amount, StationFinder &
 
 	// calculate for town stats
 
+	if (_settings_game.economy.town_cargo_batching) {
+		/* Only select the stations now, the cargo is moved in MoveBatchedTownCargo. */
+		t->supplied[ct].new_max += amount;
+		if (amount == 0) return;
+
+		Station *st1, *st2;
+		SelectStationsForGoods(ct, stations.GetStations(), &st1, &st2);
+		if (st1 == nullptr) return;
+
+		_town_cargo_batch[TownCargoBatchKey(t->index, ct, st1->index, st2 != nullptr ? st2->index : INVALID_STATION)] += amount;
+		return;
+	}
+
 	switch (ct) {
 		case CT_PASSENGERS:
 		case CT_MAIL:
@@ -684,6 +718,25 @@ static void TownGenerateCargo (Town *t, CargoID ct, uint amount, StationFinder &
 	}
 }
 
+/**
+ * Move the town cargo batched during the tile loop to the stations, once for
+ * each town, cargo and pair of stations. This is done in order of the keys,
+ * so it is deterministic.
+ */
+static void MoveBatchedTownCargo()
+{
+	for (const auto &it : _town_cargo_batch) {
+		Town *t = Town::GetIfValid(GB(it.first, 48, 16));
+		CargoID ct = GB(it.first, 32, 8);
+		Station *st1 = Station::GetIfValid(GB(it.first, 16, 16));
+		Station *st2 = Station::GetIfValid(GB(it.first, 0, 16));
+		if (t == nullptr || st1 == nullptr) continue;
+
+		t->supplied[ct].new_act += MoveGoodsToSelectedStations(ct, it.second, ST_TOWN, t->index, st1, st2);
+	}
+	_town_cargo_batch.clear();
+}
+
 /**
  * Tile callback function.
  *
@@ -1051,6 +1104,8 @@ static void TownTickHandler(Town *t)
 
 void OnTick_Town()
 {
+	if (!_town_cargo_batch.empty()) MoveBatchedTownCargo();
+
 	if (_game_mode == GM_EDITOR) return;
 
 	Town *t;
@@ -1122,6 +1177,12 @@ static bool IsRoadAllowedHere(Town *t, TileIndex tile, DiagDirection dir)
 {
 	if (DistanceFromEdge(tile) == 0) return false;
 
+	/* A house can neither get a road nor be cleared with DC_AUTO, so the
+	 * command tests below would always fail. This gives the same result as
+	 * the tests, it only saves running them for the many house tiles next to
+	 * the roads of built-up areas. */
+	if (IsTileType(tile, MP_HOUSE)) return false;
+
 	/* Prevent towns from building roads under bridges along the bridge. Looks silly. */
 	if (IsBridgeAbove(tile) && GetBridgeAxis(tile) == DiagDirToAxis(dir)) return false;
 
@@ -1674,6 +1735,9 @@ static bool GrowTownAtRoad(Town *t, TileIndex tile)
 			break;
 	}
 
+	/* The walk goes one tile at a time on purpose: every step draws from the
+	 * game random generator and may build, so walking along a cached road
+	 * graph instead would change how towns grow in existing games. */
 	do {
 		RoadBits cur_rb = GetTownRoadBits(tile); // The RoadBits of the current tile
 
@@ -3360,6 +3424,7 @@ static CommandCost TownActionBribe(Town *t, DoCommandFlag flags)
 			FOR_ALL_STATIONS(st) {
 				if (st->town == t && st->owner == _current_company) {
 					for (CargoID i = 0; i < NUM_CARGO; i++) st->goods[i].rating = 0;
+					st->rating_cargoes = ALL_CARGOTYPES;
 				}
 			}
 
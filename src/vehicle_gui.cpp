@@ -380,15 +380,28 @@ DropDownList BaseVehicleListWindow::BuildActionDropdownList(bool show_autoreplac
 	return list;
 }
 
-/* cached values for VehicleNameSorter to spare many GetString() calls */
-static const Vehicle *_last_vehicle[2] = { nullptr, nullptr };
+/** Names of the vehicles being sorted by VehicleNameSorter, so they are formatted once per sort instead of for every comparison. */
+static std::unordered_map<VehicleID, std::string> _vehicle_sort_names;
 
 void BaseVehicleListWindow::SortVehicleList()
 {
-	if (this->vehicles.Sort()) return;
+	/* The names are formatted on this thread only: the string formatter shares
+	 * the global string parameters and NewGRF text stack with everything else. */
+	bool by_name = this->vehicles.SortType() == VST_NAME && this->vehicles.WillResort();
+	if (by_name) {
+		_vehicle_sort_names.reserve(this->vehicles.size());
+		for (const Vehicle *v : this->vehicles) {
+			char buf[64];
+			SetDParam(0, v->index);
+			GetString(buf, STR_VEHICLE_NAME, lastof(buf));
+			_vehicle_sort_names[v->index] = buf;
+		}
+	}
 
-	/* invalidate cached values for name sorter - vehicle names could change */
-	_last_vehicle[0] = _last_vehicle[1] = nullptr;
+	this->vehicles.Sort();
+
+	/* Vehicle names could change before the next sort. */
+	if (by_name) _vehicle_sort_names.clear();
 }
 
 void DepotSortList(VehicleList *list)
@@ -1356,21 +1369,7 @@ static bool VehicleNumberSorter(const Vehicle * const &a, const Vehicle * const
 /** Sort vehicles by their name */
 static bool VehicleNameSorter(const Vehicle * const &a, const Vehicle * const &b)
 {
-	static char last_name[2][64];
-
-	if (a != _last_vehicle[0]) {
-		_last_vehicle[0] = a;
-		SetDParam(0, a->index);
-		GetString(last_name[0], STR_VEHICLE_NAME, lastof(last_name[0]));
-	}
-
-	if (b != _last_vehicle[1]) {
-		_last_vehicle[1] = b;
-		SetDParam(0, b->index);
-		GetString(last_name[1], STR_VEHICLE_NAME, lastof(last_name[1]));
-	}
-
-	int r = strnatcmp(last_name[0], last_name[1]); // Sort by name (natural sorting).
+	int r = strnatcmp(_vehicle_sort_names[a->index].c_str(), _vehicle_sort_names[b->index].c_str()); // Sort by name (natural sorting).
 	return (r != 0) ? r < 0: VehicleNumberSorter(a, b);
 }
 
@@ -1677,11 +1676,13 @@ void BaseVehicleListWindow::DrawVehicleListItems(VehicleID selected_vehicle, int
 		SetDParam(2, v->GetDisplayProfitLastYear());
 
 		StringID str;
+		uint num_params = 4; // The profit line in parameters 0 to 2, and one parameter of the sort criterium.
 		switch (this->vehicles.SortType()) {
 			case VST_AGE: {
 				str = (v->age + DAYS_IN_YEAR < v->max_age) ? STR_VEHICLE_LIST_AGE : STR_VEHICLE_LIST_AGE_RED;
 				SetDParam(3, v->age / DAYS_IN_LEAP_YEAR);
 				SetDParam(4, v->max_age / DAYS_IN_LEAP_YEAR);
+				num_params = 5;
 				break;
 			}
 
@@ -1711,6 +1712,7 @@ void BaseVehicleListWindow::DrawVehicleListItems(VehicleID selected_vehicle, int
 				str = STR_VEHICLE_LIST_ENGINE_BUILT;
 				SetDParam(3, v->engine_type);
 				SetDParam(4, v->build_year);
+				num_params = 5;
 				break;
 			}
 
@@ -1730,6 +1732,7 @@ void BaseVehicleListWindow::DrawVehicleListItems(VehicleID selected_vehicle, int
 				str = STR_VEHICLE_LIST_LENGTH;
 				SetDParam(3, CeilDiv(gcache->cached_total_length * 10, TILE_SIZE));
 				SetDParam(4, 1);
+				num_params = 5;
 				break;
 			}
 
@@ -1743,9 +1746,10 @@ void BaseVehicleListWindow::DrawVehicleListItems(VehicleID selected_vehicle, int
 			case VST_TIMETABLE_DELAY: {
 				if (v->lateness_counter == 0 || (!_settings_client.gui.timetable_in_ticks && v->lateness_counter / DATE_UNIT_SIZE == 0)) {
 					str = STR_VEHICLE_LIST_TIMETABLE_DELAY_ON_TIME;
+					num_params = 3;
 				} else {
 					str = v->lateness_counter > 0 ? STR_VEHICLE_LIST_TIMETABLE_DELAY_LATE : STR_VEHICLE_LIST_TIMETABLE_DELAY_EARLY;
-					SetTimetableParams(3, std::abs(v->lateness_counter));
+					num_params = 3 + SetTimetableParams(3, std::abs(v->lateness_counter));
 				}
 				break;
 			}
@@ -1763,18 +1767,20 @@ void BaseVehicleListWindow::DrawVehicleListItems(VehicleID selected_vehicle, int
 					SetDParam(3, occupancy_average - 16);
 				} else {
 					str = STR_JUST_STRING2;
+					num_params = 3;
 				}
 				break;
 			}
 
 			default: {
 				str = STR_JUST_STRING2;
+				num_params = 3;
 				break;
 			}
 		}
 
 		DrawVehicleImage(v, image_left, image_right, y + FONT_HEIGHT_SMALL - 1, selected_vehicle, EIT_IN_LIST, 0);
-		DrawString(text_left, text_right, y + line_height - FONT_HEIGHT_SMALL - WD_FRAMERECT_BOTTOM - 1, str);
+		DrawString(text_left, text_right, y + line_height - FONT_HEIGHT_SMALL - WD_FRAMERECT_BOTTOM - 1, this->info_strings.GetString(str, num_params));
 
 		/* company colour stripe along vehicle description row */
 		if (_settings_client.gui.show_vehicle_list_company_colour && v->owner != this->vli.company) {
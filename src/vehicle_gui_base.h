@@ -17,6 +17,7 @@
 #include "window_gui.h"
 #include "widgets/dropdown_type.h"
 #include "cargo_type.h"
+#include "strings_func.h"
 
 typedef GUIList<const Vehicle*, CargoID> GUIVehicleList;
 
@@ -41,6 +42,8 @@ struct BaseVehicleListWindow : public Window {
 	StringID cargo_filter_texts[NUM_CARGO + 4]; ///< Texts for filter_cargo, terminated by INVALID_STRING_ID
 	byte cargo_filter_criteria;                 ///< Selected cargo filter
 
+	mutable FormattedStringCache info_strings;  ///< Formatted profit and sort criterium lines of the vehicles.
+
 	enum ActionDropdownItem {
 		ADI_TEMPLATE_REPLACE,
 		ADI_REPLACE,
@@ -104,10 +104,13 @@
 #include "depot_base.h"
 #include "tunnelbridge_map.h"
 #include "gui.h"
+#include "worker_thread_pool.h"
 #include "core/container_func.hpp"
 #include "tunnelbridge_map.h"
 
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <math.h>
 #include <algorithm>
@@ -167,6 +170,47 @@ enum SpriteCombineMode {
 	SPRITE_COMBINE_ACTIVE,   ///< %Sprite combining is active. #AddSortableSpriteToDraw outputs child sprites.
 };
 
+/** Type of a tile drawing call recorded in the tile sprite cache. */
+enum TileSpriteCacheOpType : byte {
+	TSCOT_GROUND,          ///< #DrawGroundSpriteAt
+	TSCOT_OFFSET_GROUND,   ///< #OffsetGroundSprite
+	TSCOT_SORTABLE,        ///< #AddSortableSpriteToDraw
+	TSCOT_CHILD,           ///< #AddChildSpriteScreen
+	TSCOT_COMBINE_START,   ///< #StartSpriteCombine
+	TSCOT_COMBINE_END,     ///< #EndSpriteCombine
+};
+
+/**
+ * A drawing call made by a draw_tile_proc, as recorded in the tile sprite cache.
+ * The calls are recorded instead of their results, so that replaying them still clips against the current viewport area.
+ */
+struct TileSpriteCacheOp {
+	TileSpriteCacheOpType type;
+	bool transparent;               ///< transparent flag of #TSCOT_SORTABLE and #TSCOT_CHILD
+	bool scale;                     ///< scale flag of #TSCOT_CHILD
+	SpriteID image;
+	PaletteID pal;
+	const SubSprite *sub;
+	int32 args[9];                  ///< remaining arguments of the call, in declaration order; #TSCOT_GROUND additionally stores the tile z at the time of the call
+};
+
+/** Recorded drawing calls of a single tile at a single zoom level. */
+struct TileSpriteCacheEntry {
+	std::vector<TileSpriteCacheOp> ops;
+	int z;                          ///< TileInfo::z after drawing, foundations may have raised it
+	Slope tileh;                    ///< TileInfo::tileh after drawing, foundations may have changed it
+};
+
+static const size_t TILE_SPRITE_CACHE_MAX_ENTRIES = 1 << 16; ///< Number of cached tiles at which the tile sprite cache is flushed.
+
+/** Tile sprite cache, key is the tile index shifted left by 8 bits, ORed with the zoom level. */
+static std::unordered_map<uint64, TileSpriteCacheEntry> _tile_sprite_cache;
+
+static inline uint64 GetTileSpriteCacheKey(TileIndex tile, ZoomLevel zoom)
+{
+	return (((uint64)tile) << 8) | zoom;
+}
+
 typedef std::vector<TileSpriteToDraw> TileSpriteToDrawVector;
 typedef std::vector<StringSpriteToDraw> StringSpriteToDrawVector;
 typedef std::vector<ParentSpriteToDraw> ParentSpriteToDrawVector;
@@ -225,6 +269,8 @@ struct ViewportDrawer {
 	FoundationPart foundation_part;                  ///< Currently active foundation for ground sprite drawing.
 	int *last_foundation_child[FOUNDATION_PART_END]; ///< Tail of ChildSprite list of the foundations. (index into child_screen_sprites_to_draw)
 	Point foundation_offset[FOUNDATION_PART_END];    ///< Pixel offset for ground sprites on the foundations.
+
+	std::vector<TileSpriteCacheOp> *tile_sprite_record; ///< Drawing calls of the current tile are recorded here for the tile sprite cache, if not nullptr.
 };
 
 static void MarkViewportDirty(const ViewPort * const vp, int left, int top, int right, int bottom);
@@ -618,6 +664,30 @@ static void AddTileSpriteToDraw(SpriteID image, PaletteID pal, int32 x, int32 y,
 	ts.y = pt.y + extra_offs_y;
 }
 
+/**
+ * Append a drawing call of the current tile to the tile sprite cache record.
+ * @pre _vd.tile_sprite_record != nullptr
+ * @param type Type of the call.
+ * @param image The image argument of the call.
+ * @param pal The palette argument of the call.
+ * @param sub The sub sprite argument of the call.
+ * @return The recorded call, for the caller to fill in the remaining arguments.
+ */
+static TileSpriteCacheOp &RecordTileSpriteCacheOp(TileSpriteCacheOpType type, SpriteID image = 0, PaletteID pal = 0, const SubSprite *sub = nullptr)
+{
+	/*C++17: TileSpriteCacheOp &op = */ _vd.tile_sprite_record->emplace_back();
+	TileSpriteCacheOp &op = _vd.tile_sprite_record->back();
+	op.type = type;
+	op.transparent = false;
+	op.scale = false;
+	op.image = image;
+	op.pal = pal;
+	op.sub = sub;
+	return op;
+}
+
+static void AddChildSpriteScreenIntl(SpriteID image, PaletteID pal, int x, int y, bool transparent, const SubSprite *sub, bool scale);
+
 /**
  * Adds a child sprite to the active foundation.
  *
@@ -640,7 +710,7 @@ static void AddChildSpriteToFoundation(SpriteID image, PaletteID pal, const SubS
 	int *old_child = _vd.last_child;
 	_vd.last_child = _vd.last_foundation_child[foundation_part];
 
-	AddChildSpriteScreen(image, pal, offs.x + extra_offs_x, offs.y + extra_offs_y, false, sub, false);
+	AddChildSpriteScreenIntl(image, pal, offs.x + extra_offs_x, offs.y + extra_offs_y, false, sub, false);
 
 	/* Switch back to last ChildSprite list */
 	_vd.last_child = old_child;
@@ -661,6 +731,16 @@ static void AddChildSpriteToFoundation(SpriteID image, PaletteID pal, const SubS
  */
 void DrawGroundSpriteAt(SpriteID image, PaletteID pal, int32 x, int32 y, int z, const SubSprite *sub, int extra_offs_x, int extra_offs_y)
 {
+	if (_vd.tile_sprite_record != nullptr) {
+		TileSpriteCacheOp &op = RecordTileSpriteCacheOp(TSCOT_GROUND, image, pal, sub);
+		op.args[0] = x;
+		op.args[1] = y;
+		op.args[2] = z;
+		op.args[3] = extra_offs_x;
+		op.args[4] = extra_offs_y;
+		op.args[5] = _cur_ti->z;
+	}
+
 	/* Switch to first foundation part, if no foundation was drawn */
 	if (_vd.foundation_part == FOUNDATION_PART_NONE) _vd.foundation_part = FOUNDATION_PART_NORMAL;
 
@@ -696,6 +776,12 @@ void DrawGroundSprite(SpriteID image, PaletteID pal, const SubSprite *sub, int e
  */
 void OffsetGroundSprite(int x, int y)
 {
+	if (_vd.tile_sprite_record != nullptr) {
+		TileSpriteCacheOp &op = RecordTileSpriteCacheOp(TSCOT_OFFSET_GROUND);
+		op.args[0] = x;
+		op.args[1] = y;
+	}
+
 	/* Switch to next foundation part */
 	switch (_vd.foundation_part) {
 		case FOUNDATION_PART_NONE:
@@ -738,7 +824,7 @@ static void AddCombinedSprite(SpriteID image, PaletteID pal, int x, int y, int z
 		return;
 
 	const ParentSpriteToDraw &pstd = _vd.parent_sprites_to_draw.back();
-	AddChildSpriteScreen(image, pal, pt.x - pstd.left, pt.y - pstd.top, false, sub, false);
+	AddChildSpriteScreenIntl(image, pal, pt.x - pstd.left, pt.y - pstd.top, false, sub, false);
 }
 
 /**
@@ -772,6 +858,20 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
 
 	assert((image & SPRITE_MASK) < MAX_SPRITES);
 
+	if (_vd.tile_sprite_record != nullptr) {
+		TileSpriteCacheOp &op = RecordTileSpriteCacheOp(TSCOT_SORTABLE, image, pal, sub);
+		op.transparent = transparent;
+		op.args[0] = x;
+		op.args[1] = y;
+		op.args[2] = w;
+		op.args[3] = h;
+		op.args[4] = dz;
+		op.args[5] = z;
+		op.args[6] = bb_offset_x;
+		op.args[7] = bb_offset_y;
+		op.args[8] = bb_offset_z;
+	}
+
 	/* make the sprites transparent with the right palette */
 	if (transparent) {
 		SetBit(image, PALETTE_MODIFIER_TRANSPARENT);
@@ -866,6 +966,7 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
  */
 void StartSpriteCombine()
 {
+	if (_vd.tile_sprite_record != nullptr) RecordTileSpriteCacheOp(TSCOT_COMBINE_START);
 	assert(_vd.combine_sprites == SPRITE_COMBINE_NONE);
 	_vd.combine_sprites = SPRITE_COMBINE_PENDING;
 }
@@ -876,6 +977,7 @@ void StartSpriteCombine()
  */
 void EndSpriteCombine()
 {
+	if (_vd.tile_sprite_record != nullptr) RecordTileSpriteCacheOp(TSCOT_COMBINE_END);
 	assert(_vd.combine_sprites != SPRITE_COMBINE_NONE);
 	_vd.combine_sprites = SPRITE_COMBINE_NONE;
 }
@@ -927,6 +1029,23 @@ static bool IsInsideSelectedRectangle(int x, int y)
  * @param sub Only draw a part of the sprite.
  */
 void AddChildSpriteScreen(SpriteID image, PaletteID pal, int x, int y, bool transparent, const SubSprite *sub, bool scale)
+{
+	if (_vd.tile_sprite_record != nullptr) {
+		TileSpriteCacheOp &op = RecordTileSpriteCacheOp(TSCOT_CHILD, image, pal, sub);
+		op.transparent = transparent;
+		op.scale = scale;
+		op.args[0] = x;
+		op.args[1] = y;
+	}
+
+	AddChildSpriteScreenIntl(image, pal, x, y, transparent, sub, scale);
+}
+
+/**
+ * Add a child sprite to a parent sprite, without recording it in the tile sprite cache.
+ * @see AddChildSpriteScreen
+ */
+static void AddChildSpriteScreenIntl(SpriteID image, PaletteID pal, int x, int y, bool transparent, const SubSprite *sub, bool scale)
 {
 	assert((image & SPRITE_MASK) < MAX_SPRITES);
 
@@ -1185,6 +1304,101 @@ static int GetViewportY(Point tile)
 	return (tile.y * (int)(TILE_PIXELS / 2) + tile.x * (int)(TILE_PIXELS / 2) - TilePixelHeightOutsideMap(tile.x, tile.y)) << ZOOM_LVL_SHIFT;
 }
 
+/**
+ * Replay the drawing calls of a tile recorded in the tile sprite cache.
+ * @param ti Tile being drawn, its height and slope are updated as the draw_tile_proc would have.
+ * @param entry Cache entry of the tile.
+ */
+static void ReplayTileSpriteCacheEntry(TileInfo *ti, const TileSpriteCacheEntry &entry)
+{
+	for (const TileSpriteCacheOp &op : entry.ops) {
+		switch (op.type) {
+			case TSCOT_GROUND:
+				ti->z = op.args[5];
+				DrawGroundSpriteAt(op.image, op.pal, op.args[0], op.args[1], op.args[2], op.sub, op.args[3], op.args[4]);
+				break;
+
+			case TSCOT_OFFSET_GROUND:
+				OffsetGroundSprite(op.args[0], op.args[1]);
+				break;
+
+			case TSCOT_SORTABLE:
+				AddSortableSpriteToDraw(op.image, op.pal, op.args[0], op.args[1], op.args[2], op.args[3], op.args[4], op.args[5], op.transparent, op.args[6], op.args[7], op.args[8], op.sub);
+				break;
+
+			case TSCOT_CHILD:
+				AddChildSpriteScreenIntl(op.image, op.pal, op.args[0], op.args[1], op.transparent, op.sub, op.scale);
+				break;
+
+			case TSCOT_COMBINE_START:
+				StartSpriteCombine();
+				break;
+
+			case TSCOT_COMBINE_END:
+				EndSpriteCombine();
+				break;
+
+			default: NOT_REACHED();
+		}
+	}
+	ti->z = entry.z;
+	ti->tileh = entry.tileh;
+}
+
+/**
+ * Draw a tile through its draw_tile_proc, or through the recorded drawing calls in the tile sprite cache if these are available.
+ * @param ti Tile to draw.
+ * @param tile_type Type of the tile.
+ */
+static void ViewportDrawTileCached(TileInfo *ti, TileType tile_type)
+{
+	const uint64 key = GetTileSpriteCacheKey(ti->tile, _vd.dpi.zoom);
+	auto iter = _tile_sprite_cache.find(key);
+	if (iter != _tile_sprite_cache.end()) {
+		ReplayTileSpriteCacheEntry(ti, iter->second);
+		return;
+	}
+
+	if (_tile_sprite_cache.size() >= TILE_SPRITE_CACHE_MAX_ENTRIES) _tile_sprite_cache.clear();
+
+	TileSpriteCacheEntry &entry = _tile_sprite_cache[key];
+	_vd.tile_sprite_record = &entry.ops;
+	_tile_type_procs[tile_type]->draw_tile_proc(ti);
+	_vd.tile_sprite_record = nullptr;
+	entry.z = ti->z;
+	entry.tileh = ti->tileh;
+}
+
+/**
+ * Remove a tile and its neighbours from the tile sprite cache.
+ * The neighbours are included as their drawing may depend on the tile, e.g. for fences or foundations.
+ * @param tile Tile which changed.
+ */
+static void InvalidateTileSpriteCacheByTile(TileIndex tile)
+{
+	if (_tile_sprite_cache.empty()) return;
+
+	const int tx = TileX(tile);
+	const int ty = TileY(tile);
+	for (int x = max<int>(tx - 1, 0); x <= min<int>(tx + 1, MapMaxX()); x++) {
+		for (int y = max<int>(ty - 1, 0); y <= min<int>(ty + 1, MapMaxY()); y++) {
+			const TileIndex t = TileXY(x, y);
+			for (ZoomLevel zoom = ZOOM_LVL_BEGIN; zoom < ZOOM_LVL_DRAW_MAP; zoom++) {
+				_tile_sprite_cache.erase(GetTileSpriteCacheKey(t, zoom));
+			}
+		}
+	}
+}
+
+/**
+ * Clear the whole tile sprite cache.
+ * This is required whenever something other than the map changes how tiles are drawn, e.g. settings, transparency or sprites.
+ */
+void ClearTileSpriteCache()
+{
+	_tile_sprite_cache.clear();
+}
+
 /**
  * Add the landscape to the viewport, i.e. all ground tiles and buildings.
  */
@@ -1295,7 +1509,11 @@ static void ViewportAddLandscape()
 				_vd.last_foundation_child[0] = nullptr;
 				_vd.last_foundation_child[1] = nullptr;
 
-				_tile_type_procs[tile_type]->draw_tile_proc(&tile_info);
+				if (_settings_client.gui.cache_tile_sprites && tile_info.tile != INVALID_TILE) {
+					ViewportDrawTileCached(&tile_info, tile_type);
+				} else {
+					_tile_type_procs[tile_type]->draw_tile_proc(&tile_info);
+				}
 				if (tile_info.tile != INVALID_TILE) {
 					DrawTileSelection(&tile_info);
 					DrawTileZoning(&tile_info);
@@ -1615,6 +1833,9 @@ static void ViewportDrawBoundingBoxes(const ParentSpriteToSortVector *psd)
 	}
 }
 
+/** Protects the tunnel and bridge lists of #_vd while the map of a viewport is drawn by several threads. */
+static std::mutex _vp_map_bridge_tunnel_mutex;
+
 static void ViewportMapStoreBridgeTunnel(const ViewPort * const vp, const TileIndex tile)
 {
 	extern LegendAndColour _legend_land_owners[NUM_NO_COMPANY_ENTRIES + MAX_COMPANIES + 1];
@@ -1630,6 +1851,8 @@ static void ViewportMapStoreBridgeTunnel(const ViewPort * const vp, const TileIn
 	const Owner o = GetTileOwner(tile);
 	if (o < MAX_COMPANIES && !_legend_land_owners[_company_to_list_pos[o]].show_on_map) return;
 
+	std::lock_guard<std::mutex> lock(_vp_map_bridge_tunnel_mutex);
+
 	/* Check if already stored */
 	TunnelBridgeToMapVector * const tbtmv = tile_is_tunnel ? &_vd.tunnel_to_map : &_vd.bridge_to_map;
 	TunnelBridgeToMap *tbtm = tbtmv->data();
@@ -2253,18 +2476,22 @@ static inline void ViewportMapStoreBridgeAboveTile(const ViewPort * const vp, co
 	/* No need to bother for hidden things */
 	if (!_settings_client.gui.show_bridges_on_map) return;
 
-	/* Check existing stored bridges */
-	for (const TunnelBridgeToMap &tbtm : _vd.bridge_to_map) {
-		if (!IsBridge(tbtm.from_tile)) continue;
-
-		TileIndex from = tbtm.from_tile;
-		TileIndex to = tbtm.to_tile;
-		if (TileX(from) == TileX(to) && TileX(from) == TileX(tile)) {
-			if (TileY(from) > TileY(to)) std::swap(from, to);
-			if (TileY(from) <= TileY(tile) && TileY(tile) <= TileY(to)) return; /* already covered */
-		} else if (TileY(from) == TileY(to) && TileY(from) == TileY(tile)) {
-			if (TileX(from) > TileX(to)) std::swap(from, to);
-			if (TileX(from) <= TileX(tile) && TileX(tile) <= TileX(to)) return; /* already covered */
+	{
+		std::lock_guard<std::mutex> lock(_vp_map_bridge_tunnel_mutex);
+
+		/* Check existing stored bridges */
+		for (const TunnelBridgeToMap &tbtm : _vd.bridge_to_map) {
+			if (!IsBridge(tbtm.from_tile)) continue;
+
+			TileIndex from = tbtm.from_tile;
+			TileIndex to = tbtm.to_tile;
+			if (TileX(from) == TileX(to) && TileX(from) == TileX(tile)) {
+				if (TileY(from) > TileY(to)) std::swap(from, to);
+				if (TileY(from) <= TileY(tile) && TileY(tile) <= TileY(to)) return; /* already covered */
+			} else if (TileY(from) == TileY(to) && TileY(from) == TileY(tile)) {
+				if (TileX(from) > TileX(to)) std::swap(from, to);
+				if (TileX(from) <= TileX(tile) && TileX(tile) <= TileX(to)) return; /* already covered */
+			}
 		}
 	}
 
@@ -2460,15 +2687,19 @@ static void ViewportMapDrawBridgeTunnel(const ViewPort * const vp, const TunnelB
 	}
 }
 
-/** Draw the map on a viewport. */
+/**
+ * Render lines of the base map of a viewport in map mode.
+ * Lines are independent of each other, so several threads can each render a subset of the lines.
+ * @param vp The viewport.
+ * @param line_buffer Buffer to assemble a line in, at least as wide as the drawn area.
+ * @param first_line First line to render.
+ * @param line_step Distance between the rendered lines.
+ */
 template <bool is_32bpp, bool show_slope>
-void ViewportMapDraw(const ViewPort * const vp)
+static void ViewportMapDrawLines(const ViewPort * const vp, uint32 * const line_buffer, const int first_line, const int line_step)
 {
-	assert(vp != nullptr);
 	Blitter * const blitter = BlitterFactory::GetCurrentBlitter();
 
-	SmallMapWindow::RebuildColourIndexIfNecessary();
-
 	/* Index of colour: _green_map_heights[] contains blocks of 4 colours, say ABCD
 	 * For a XXXY colour block to render nicely, follow the model:
 	 *   line 1: ABCDABCDABCD
@@ -2479,26 +2710,23 @@ void ViewportMapDraw(const ViewPort * const vp)
 	const  int sx = UnScaleByZoomLower(_vd.dpi.left, _vd.dpi.zoom);
 	const  int sy = UnScaleByZoomLower(_vd.dpi.top, _vd.dpi.zoom);
 	const uint line_padding = 2 * (sy & 1);
-	uint       colour_index_base = (sx + line_padding) & 3;
+	const uint colour_index_base = (sx + line_padding) & 3;
 
 	const  int incr_a = (1 << (vp->zoom - 2)) / ZOOM_LVL_BASE;
 	const  int incr_b = (1 << (vp->zoom - 1)) / ZOOM_LVL_BASE;
 	const  int a = (_vd.dpi.left >> 2) / ZOOM_LVL_BASE;
-	int        b = (_vd.dpi.top >> 1) / ZOOM_LVL_BASE;
+	const  int b = (_vd.dpi.top >> 1) / ZOOM_LVL_BASE;
 	const  int w = UnScaleByZoom(_vd.dpi.width, vp->zoom);
 	const  int h = UnScaleByZoom(_vd.dpi.height, vp->zoom);
-	int        j = 0;
 
-	/* Render base map. */
-	do { // For each line
-		int i = w;
-		uint colour_index = colour_index_base;
-		colour_index_base ^= 2;
-		uint32 *vp_map_line_ptr32 = _vp_map_line;
-		uint8 *vp_map_line_ptr8 = (uint8*) _vp_map_line;
-		int c = b - a;
-		int d = b + a;
-		do { // For each pixel of a line
+	for (int j = first_line; j < h; j += line_step) { // For each line
+		uint colour_index = colour_index_base ^ ((j & 1) << 1);
+		uint32 *vp_map_line_ptr32 = line_buffer;
+		uint8 *vp_map_line_ptr8 = (uint8*) line_buffer;
+		const int line_b = b + j * incr_b;
+		int c = line_b - a;
+		int d = line_b + a;
+		for (int i = 0; i < w; i++) { // For each pixel of a line
 			if (is_32bpp) {
 				*vp_map_line_ptr32 = ViewportMapGetColour<is_32bpp, show_slope>(vp, c, d, colour_index);
 				vp_map_line_ptr32++;
@@ -2509,14 +2737,65 @@ void ViewportMapDraw(const ViewPort * const vp)
 			colour_index = (colour_index + 1) & 3;
 			c -= incr_a;
 			d += incr_a;
-		} while (--i);
+		}
 		if (is_32bpp) {
-			blitter->SetLine32(_vd.dpi.dst_ptr, 0, j, _vp_map_line, w);
+			blitter->SetLine32(_vd.dpi.dst_ptr, 0, j, line_buffer, w);
 		} else {
-			blitter->SetLine(_vd.dpi.dst_ptr, 0, j, (uint8*) _vp_map_line, w);
+			blitter->SetLine(_vd.dpi.dst_ptr, 0, j, (uint8*) line_buffer, w);
 		}
-		b += incr_b;
-	} while (++j < h);
+	}
+}
+
+static const uint VP_MAP_MAX_DRAW_THREADS = 8;            ///< Maximum number of threads drawing the map of a viewport.
+static const uint VP_MAP_MIN_PIXELS_PER_DRAW_THREAD = 32768; ///< Minimum number of pixels of the drawn area per thread, smaller areas are drawn by the calling thread alone.
+
+/**
+ * Get the number of threads to use to draw the base map of an area of a viewport.
+ * @param w Width of the area, in pixels.
+ * @param h Height of the area, in pixels.
+ * @return Number of threads, including the calling thread.
+ */
+static uint ViewportMapGetDrawThreadCount(int w, int h)
+{
+	uint threads = min<uint>((uint)(w * h) / VP_MAP_MIN_PIXELS_PER_DRAW_THREAD, VP_MAP_MAX_DRAW_THREADS);
+	threads = min<uint>(threads, (uint)h);
+	if (threads <= 1) return 1;
+	return min<uint>(threads, _worker_thread_pool.GetThreadCount());
+}
+
+static bool TunnelBridgeToMapSorter(const TunnelBridgeToMap &a, const TunnelBridgeToMap &b)
+{
+	return a.from_tile < b.from_tile;
+}
+
+/** Draw the map on a viewport. */
+template <bool is_32bpp, bool show_slope>
+void ViewportMapDraw(const ViewPort * const vp)
+{
+	assert(vp != nullptr);
+	Blitter * const blitter = BlitterFactory::GetCurrentBlitter();
+
+	SmallMapWindow::RebuildColourIndexIfNecessary();
+
+	const  int w = UnScaleByZoom(_vd.dpi.width, vp->zoom);
+	const  int h = UnScaleByZoom(_vd.dpi.height, vp->zoom);
+
+	/* Render base map. */
+	const uint threads = ViewportMapGetDrawThreadCount(w, h);
+	if (threads > 1) {
+		/* Split the lines between the worker threads, the calling thread renders its share too. */
+		std::vector<uint32> line_buffers((threads - 1) * w);
+		_worker_thread_pool.Run(threads, [&](uint k) {
+			uint32 *line_buffer = (k == 0) ? _vp_map_line : line_buffers.data() + (k - 1) * w;
+			ViewportMapDrawLines<is_32bpp, show_slope>(vp, line_buffer, (int)k, (int)threads);
+		});
+
+		/* The threads found the tunnels and bridges in arbitrary order, sort them to draw them the same way every time. */
+		std::sort(_vd.tunnel_to_map.begin(), _vd.tunnel_to_map.end(), TunnelBridgeToMapSorter);
+		std::sort(_vd.bridge_to_map.begin(), _vd.bridge_to_map.end(), TunnelBridgeToMapSorter);
+	} else {
+		ViewportMapDrawLines<is_32bpp, show_slope>(vp, _vp_map_line, 0, 1);
+	}
 
 	/* Render tunnels */
 	if (_settings_client.gui.show_tunnels_on_map && _vd.tunnel_to_map.size() != 0) {
@@ -2951,6 +3230,8 @@ void ConstrainAllViewportsZoom()
  */
 void MarkTileDirtyByTile(TileIndex tile, const ZoomLevel mark_dirty_if_zoomlevel_is_below, int bridge_level_offset, int tile_height_override)
 {
+	InvalidateTileSpriteCacheByTile(tile);
+
 	Point pt = RemapCoords(TileX(tile) * TILE_SIZE, TileY(tile) * TILE_SIZE, tile_height_override * TILE_HEIGHT);
 	MarkAllViewportsDirty(
 			pt.x - 31  * ZOOM_LVL_BASE,
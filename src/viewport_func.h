@@ -111,6 +111,8 @@ Point GetViewportStationMiddle(const ViewPort *vp, const Station *st);
 
 void ShowTooltipForTile(Window *w, const TileIndex tile);
 
+void ClearTileSpriteCache();
+
 void ViewportMapClearTunnelCache();
 void ViewportMapInvalidateTunnelCacheByTile(const TileIndex tile);
 
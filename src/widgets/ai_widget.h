@@ -68,6 +68,7 @@ enum AIDebugWidgets {
 	WID_AID_BREAK_STR_EDIT_BOX,   ///< Edit box for the string to break on.
 	WID_AID_MATCH_CASE_BTN,       ///< Checkbox to use match caching or not.
 	WID_AID_CONTINUE_BTN,         ///< Continue button.
+	WID_AID_PROFILE,              ///< Profiling counters of the script.
 };
 
 #endif /* WIDGETS_AI_WIDGET_H */
@@ -0,0 +1,120 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_thread_pool.cpp Pool of persistent threads to split work of the main thread into parallel jobs. */
+
+#include "stdafx.h"
+#include "worker_thread_pool.h"
+#include "core/math_func.hpp"
+
+#include "safeguards.h"
+
+static const uint WORKER_THREAD_POOL_MAX_THREADS = 16; ///< Maximum number of threads running jobs, including the calling thread.
+
+WorkerThreadPool _worker_thread_pool;
+
+WorkerThreadPool::~WorkerThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->exit = true;
+	}
+	this->work_sig.notify_all();
+	for (std::thread &worker : this->workers) {
+		if (worker.joinable()) worker.join();
+	}
+}
+
+/** Start the worker threads, unless that was already attempted. */
+void WorkerThreadPool::Start()
+{
+	if (this->started) return;
+	this->started = true;
+
+	uint threads = Clamp<uint>(std::thread::hardware_concurrency(), 1, WORKER_THREAD_POOL_MAX_THREADS);
+	for (uint i = 1; i < threads; i++) {
+		this->workers.emplace_back();
+		if (!StartNewThread(&this->workers.back(), "ottd:worker", [this]() { this->WorkerLoop(); })) {
+			this->workers.pop_back();
+			break;
+		}
+	}
+}
+
+/**
+ * Get the number of threads jobs run on, including the thread calling #Run.
+ * @return The number of threads.
+ */
+uint WorkerThreadPool::GetThreadCount()
+{
+	std::lock_guard<std::mutex> lock(this->run_mutex);
+	this->Start();
+	return (uint)this->workers.size() + 1;
+}
+
+/** Run jobs of the current batch on the current thread, until none are left. */
+void WorkerThreadPool::RunJobs()
+{
+	for (uint job = this->next_job++; job < this->jobs; job = this->next_job++) {
+		(*this->func)(job);
+	}
+}
+
+/** Main loop of the worker threads. */
+void WorkerThreadPool::WorkerLoop()
+{
+	uint seen_generation = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->work_sig.wait(lock, [&]() { return this->exit || this->generation != seen_generation; });
+			if (this->exit) return;
+			seen_generation = this->generation;
+		}
+
+		this->RunJobs();
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (--this->busy_workers == 0) this->done_sig.notify_one();
+	}
+}
+
+/**
+ * Run a batch of jobs on the worker threads and the calling thread, and wait until all are done.
+ * @param jobs Number of jobs.
+ * @param func Function running a job, it is called with every index from 0 to \a jobs - 1 exactly once.
+ * @note Jobs must not call #Run themselves.
+ */
+void WorkerThreadPool::Run(uint jobs, const JobFunction &func)
+{
+	std::lock_guard<std::mutex> run_lock(this->run_mutex);
+	this->Start();
+
+	this->func = &func;
+	this->jobs = jobs;
+	this->next_job = 0;
+
+	if (jobs > 1 && !this->workers.empty()) {
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->busy_workers = (uint)this->workers.size();
+			this->generation++;
+		}
+		this->work_sig.notify_all();
+
+		this->RunJobs();
+
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->done_sig.wait(lock, [&]() { return this->busy_workers == 0; });
+	} else {
+		this->RunJobs();
+	}
+
+	this->func = nullptr;
+}
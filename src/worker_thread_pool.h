@@ -0,0 +1,62 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_thread_pool.h Pool of persistent threads to split work of the main thread into parallel jobs. */
+
+#ifndef WORKER_THREAD_POOL_H
+#define WORKER_THREAD_POOL_H
+
+#include "thread.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#if defined(__MINGW32__)
+#include "3rdparty/mingw-std-threads/mingw.mutex.h"
+#include "3rdparty/mingw-std-threads/mingw.condition_variable.h"
+#endif
+
+/**
+ * Pool of worker threads which are started on first use and kept until the game exits,
+ * so running a batch of jobs does not have to pay for creating threads.
+ */
+class WorkerThreadPool {
+public:
+	/** Function running the job with the given index. */
+	typedef std::function<void(uint)> JobFunction;
+
+	~WorkerThreadPool();
+
+	uint GetThreadCount();
+	void Run(uint jobs, const JobFunction &func);
+
+private:
+	std::vector<std::thread> workers;   ///< The worker threads.
+	bool started = false;               ///< Whether starting the worker threads was attempted.
+	bool exit = false;                  ///< Whether the worker threads should exit.
+
+	std::mutex run_mutex;               ///< Serialises calls to #Run.
+	std::mutex mutex;                   ///< Protects the state below.
+	std::condition_variable work_sig;   ///< Signalled when there is a new batch of jobs or the workers should exit.
+	std::condition_variable done_sig;   ///< Signalled when the last job of a batch is done.
+	uint generation = 0;                ///< Number of the current batch of jobs.
+	const JobFunction *func = nullptr;  ///< Function of the current batch of jobs.
+	uint jobs = 0;                      ///< Number of jobs of the current batch.
+	std::atomic<uint> next_job;         ///< Index of the next job of the current batch to run.
+	uint busy_workers = 0;              ///< Number of worker threads still working on the current batch.
+
+	void Start();
+	void RunJobs();
+	void WorkerLoop();
+};
+
+extern WorkerThreadPool _worker_thread_pool;
+
+#endif /* WORKER_THREAD_POOL_H */